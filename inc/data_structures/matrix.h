@@ -11,16 +11,52 @@
 
 typedef double m_data_t;
 
+/* How the entries of a matrix are laid out in its data.  Row-major keeps rows
+   contiguous, column-major (what Fortran and BLAS-style tools use) keeps
+   columns contiguous.  Every m_* function takes matricies in either order,
+   and operands of one call can mix orders.
+*/
+typedef enum m_order {
+    M_ROW_MAJOR = 0,
+    M_COL_MAJOR = 1,
+} m_order_t;
+
 typedef struct m
 {
     size_t rows;
     size_t cols;
+    m_order_t order;
     m_data_t *data;
 } m_t;
 
+/* Returns a new row-major matrix.  No values are set. */
 m_t *m_new(size_t rows, size_t cols);
+/* Returns a new matrix stored in the given order, or NULL if order isn't
+   M_ROW_MAJOR or M_COL_MAJOR.  No values are set. */
+m_t *m_new_ordered(size_t rows, size_t cols, m_order_t order);
 error_t m_del(m_t *m);
 
+/* Fills in mat as a view of an existing rows x cols buffer stored in the
+   given order, for example one shared with a column-major library.  Nothing
+   is copied or allocated.  The buffer still belongs to the caller, so don't
+   m_del a view.
+*/
+error_t m_init_view(m_t *mat, size_t rows, size_t cols, m_order_t order, m_data_t *data);
+
+/* Distance in data between neighbouring rows and neighbouring columns.  Entry
+   (m, n) lives at data[m*m_row_stride(mat) + n*m_col_stride(mat)].  Kernels
+   that walk data directly should use these instead of assuming an order.
+*/
+static inline size_t m_row_stride(const m_t *mat)
+{
+    return mat->order == M_COL_MAJOR ? 1 : mat->cols;
+}
+
+static inline size_t m_col_stride(const m_t *mat)
+{
+    return mat->order == M_COL_MAJOR ? mat->rows : 1;
+}
+
 error_t m_set(m_t *mat, size_t m, size_t n, m_data_t val);
 m_data_t m_get(m_t *mat, size_t m, size_t n);
 
@@ -33,13 +69,15 @@ error_t m_mult(m_t *lhs, m_t *rhs, m_t *res);
 
 /*  Add two matricies of the same dimensions.
 
-    It is alright for rhs and/or lhs to be the same as res
+    It is alright for rhs and/or lhs to be the same as res, but only if they
+    share res's storage order.
 */
 error_t m_add(m_t *lhs, m_t *rhs, m_t *res);
 
 /*  Negate a matrix.
 
-    It is alright for mat to be the same as res
+    It is alright for mat to be the same as res, but only if they share a
+    storage order.
 */
 error_t m_negate(m_t *mat, m_t *res);
 
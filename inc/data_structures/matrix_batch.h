@@ -0,0 +1,48 @@
+#ifndef __MATRIX_BATCH_H__7878787
+#define __MATRIX_BATCH_H__7878787
+
+#include <stdlib.h>
+
+#include "errors.h"
+#include "data_structures/matrix.h"
+
+/* A batch of count independent rows x cols matricies stored interleaved with
+   the batch index innermost: entry (m, n) of matrix b is at
+
+       data[(m*cols + n)*count + b]
+
+   So the same entry of every matrix in the batch is contiguous, and the
+   batched kernels loop over the batch in their innermost loop.  Every SIMD
+   lane then works on a different matrix, which vectorizes fine even for
+   matricies far too small to vectorize on their own (6x6, 9x9, ...).
+*/
+typedef struct m_batch
+{
+    size_t rows;
+    size_t cols;
+    size_t count;
+    m_data_t *data;
+} m_batch_t;
+
+/* Returns a new batch of count rows x cols matricies.  No values are set. */
+m_batch_t* m_batch_new(size_t rows, size_t cols, size_t count);
+error_t m_batch_del(m_batch_t *batch);
+
+error_t m_batch_set(m_batch_t *batch, size_t idx, size_t m, size_t n, m_data_t val);
+m_data_t m_batch_get(m_batch_t *batch, size_t idx, size_t m, size_t n);
+
+/* Copy matrix idx of the batch to or from an ordinary matrix of the same size. */
+error_t m_batch_load(m_batch_t *batch, size_t idx, m_t *mat);
+error_t m_batch_store(m_batch_t *batch, size_t idx, m_t *mat);
+
+/* Returns true if a and b have the same matrix dimensions and count. */
+bool m_batch_same_size(m_batch_t *a, m_batch_t *b);
+
+/* Multiplies every pair of matricies such that:
+     res[b] = lhs[b]*rhs[b]
+
+   It is NOT alright for res to be the lhs or rhs.
+*/
+error_t m_batch_mult(m_batch_t *lhs, m_batch_t *rhs, m_batch_t *res);
+
+#endif /* __MATRIX_BATCH_H__7878787 */
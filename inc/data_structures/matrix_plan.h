@@ -0,0 +1,74 @@
+#ifndef __MATRIX_PLAN_H__5656565
+#define __MATRIX_PLAN_H__5656565
+
+#include <stdlib.h>
+
+#include "errors.h"
+#include "data_structures/matrix.h"
+#include "data_structures/vector.h"
+
+/* A plan records a fixed sequence of matrix operations once and then replays
+   it as many times as you like.
+
+   All of the validation the m_* functions do on every call (NULL pointers,
+   dimensions, aliasing) happens once when an operation is recorded.  The
+   kernel for each operation is picked at record time too, so m_plan_run
+   just walks the list of recorded operations with no checks and no
+   allocation.
+
+   A plan holds on to the data pointers of the operands it was recorded with.
+   The operands must outlive the plan and must not be resized or reallocated
+   while the plan is in use.  Their contents can (and should!) change between
+   runs.
+*/
+typedef struct m_plan m_plan_t;
+
+/* Returns a new, empty plan.  workspace_len is the total number of m_data_t
+   entries available to m_plan_scratch for intermediate results.  It can be 0
+   if you do not need any scratch matricies.
+*/
+m_plan_t* m_plan_new(size_t workspace_len);
+error_t m_plan_del(m_plan_t *plan);
+
+/* Returns a rows x cols matrix whose storage lives in the plan's workspace.
+   Use these for intermediate results.  They are owned by the plan; do NOT
+   m_del them.  Returns NULL if the workspace does not have room left.
+*/
+m_t* m_plan_scratch(m_plan_t *plan, size_t rows, size_t cols);
+
+/****
+ * Recording functions.  Each one validates its operands exactly like the
+ * corresponding m_* function and returns an error without recording anything
+ * if they are no good.  Operands are compared by their data, so a scratch
+ * matrix and a matrix sharing its storage count as the same matrix.
+ ****/
+
+/* Records res = lhs*rhs.  It is NOT alright for res to be the lhs or rhs. */
+error_t m_plan_mult(m_plan_t *plan, m_t *lhs, m_t *rhs, m_t *res);
+
+/* Records res = mat*vec.  It is NOT alright for res to be vec. */
+error_t m_plan_mult_vector(m_plan_t *plan, m_t *mat, v_t *vec, v_t *res);
+
+/* Records res = lhs+rhs.  It is alright for rhs and/or lhs to be the same as
+   res, but only if they share res's storage order.
+*/
+error_t m_plan_add(m_plan_t *plan, m_t *lhs, m_t *rhs, m_t *res);
+
+/* Records res = -mat.  It is alright for mat to be the same as res, but only
+   if they share a storage order.
+*/
+error_t m_plan_negate(m_plan_t *plan, m_t *mat, m_t *res);
+
+/* Records res = mat^T.  It is NOT alright for res to be mat. */
+error_t m_plan_transpose(m_plan_t *plan, m_t *mat, m_t *res);
+
+/* Records a copy of src into dest. */
+error_t m_plan_copy(m_plan_t *plan, m_t *src, m_t *dest);
+
+/* Returns the number of operations recorded so far. */
+size_t m_plan_len(const m_plan_t *plan);
+
+/* Replays every recorded operation in the order it was recorded. */
+error_t m_plan_run(const m_plan_t *plan);
+
+#endif /* __MATRIX_PLAN_H__5656565 */
@@ -3,13 +3,15 @@
 
 #include "errors.h"
 #include "data_structures/matrix.h"
+#include "data_structures/vector.h"
+#include "integrators/lti.h"
 
 typedef struct kalman_context {
-    /* Alpha must hold to: 1e-4 <= alpha <= 1*/
-    double alpha = 1e-4;
+    /* Alpha must hold to: 1e-4 <= alpha <= 1.  1e-4 is a good default. */
+    double alpha;
 
     /* Beta of 2 is best for gaussian distributed state vectors */
-    double beta = 2;
+    double beta;
 
     // Any of the fields with leading underscores are internal scratch pad values that you
     // should not touch.
@@ -19,4 +21,14 @@ typedef struct kalman_context {
 
 } kalman_context_t;
 
-#endif
\ No newline at end of file
+/* Kalman predict step for a linear time-invariant segment:
+       x = Phi x + Gamma u
+       P = Phi P Phi^T + Qd
+   disc must have a Qd.  Pair it with an lti_cache so repeated predicts over
+   the same segment reuse the same Phi and Qd instead of rediscretizing.
+   u is ignored if disc has no Gamma.  On failure x and P are left as they
+   were.
+*/
+error_t kalman_predict(lti_discrete_t *disc, v_t *x, v_t *u, m_t *P);
+
+#endif
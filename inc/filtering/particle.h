@@ -0,0 +1,158 @@
+#ifndef __FILTERING_PARTICLE_H__
+#define __FILTERING_PARTICLE_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "errors.h"
+#include "data_structures/vector.h"
+#include "parallel/thread_pool.h"
+
+/* A bootstrap particle filter for large particle counts.
+
+   All the particles live in one structure-of-arrays block: component d of
+   particle i is states[d*n_particles + i], so kernels walking one component
+   across many particles run over contiguous memory.  Weights are kept as
+   normalized log weights.
+
+   Propagation and weighting are split into fixed size chunks of particles
+   run on the thread pool.  Each chunk has its own random number generator
+   seeded from the filter's seed, so results do not depend on the number of
+   threads.
+*/
+
+/* Particles per chunk handed to the thread pool. */
+#define PARTICLE_CHUNK 4096
+
+/* xoshiro256+ state, one per chunk. */
+typedef struct particle_rng {
+    uint64_t s[4];
+} particle_rng_t;
+
+/* Returns a uniform draw in [0, 1). */
+double particle_rng_uniform(particle_rng_t *rng);
+/* Returns a standard normal draw. */
+double particle_rng_normal(particle_rng_t *rng);
+
+/* A particle_propagate_fn moves particles [begin, end) forward by dt in
+   place.  Component d of particle i is states[d*stride + i].  Noise must be
+   drawn from rng.
+*/
+typedef error_t (*particle_propagate_fn)(
+                                        void *ctx,
+                                        v_data_t *states,
+                                        size_t stride,
+                                        size_t begin,
+                                        size_t end,
+                                        float dt,
+                                        v_t *cur_ctrl,
+                                        particle_rng_t *rng
+                                        );
+
+/* A particle_loglik_fn writes log p(meas | particle i) into log_lik[i] for
+   particles [begin, end).  Component d of particle i is states[d*stride + i].
+*/
+typedef error_t (*particle_loglik_fn)(
+                                     void *ctx,
+                                     const v_data_t *states,
+                                     size_t stride,
+                                     size_t begin,
+                                     size_t end,
+                                     v_t *meas,
+                                     v_data_t *log_lik
+                                     );
+
+/* Context for particle_loglik_gaussian: measurement j is state component
+   dims[j] plus gaussian noise with standard deviation sigma[j].
+*/
+typedef struct particle_gaussian {
+    const size_t *dims;
+    const v_data_t *sigma;
+    size_t n_meas;
+} particle_gaussian_t;
+
+/* A particle_loglik_fn for direct, independent gaussian measurements of some
+   of the state components.  ctx is a particle_gaussian_t.
+*/
+error_t particle_loglik_gaussian(void *ctx, const v_data_t *states, size_t stride,
+                                 size_t begin, size_t end, v_t *meas, v_data_t *log_lik);
+
+typedef enum particle_resample {
+    PARTICLE_SYSTEMATIC, /* One uniform offset shared by every slot */
+    PARTICLE_STRATIFIED, /* An independent uniform offset per slot */
+} particle_resample_t;
+
+typedef struct particle_filter {
+    size_t n_particles;
+    size_t st_len;
+
+    /* st_len x n_particles, component-major as described above. */
+    v_data_t *states;
+    /* log_weights[i] is the normalized log weight of particle i. */
+    v_data_t *log_weights;
+
+    particle_propagate_fn propagate_fn;
+    particle_loglik_fn loglik_fn;
+    void *ctx;
+
+    // Any of the fields with leading underscores are internal scratch pad values that you
+    // should not touch.
+    v_data_t *_states_back;
+    size_t *_idx;
+    size_t _n_chunks;
+    particle_rng_t *_rng;
+    particle_rng_t _rng_resample;
+    error_t *_chunk_err;
+    v_data_t *_chunk_val;
+    parallel_graph_t *_propagate;
+    parallel_graph_t *_weigh;
+    parallel_graph_t *_sum;
+    parallel_graph_t *_normalize;
+    parallel_graph_t *_gather;
+    float _dt;
+    v_t *_ctrl;
+    v_t *_meas;
+    v_data_t _shift;
+} particle_filter_t;
+
+/* Returns a new filter of n_particles particles with st_len states each,
+   all allocated up front.  The states are left unset and the weights
+   uniform.  ctx is passed to propagate_fn and loglik_fn.
+*/
+particle_filter_t* particle_filter_new(size_t n_particles, size_t st_len,
+                                       particle_propagate_fn propagate_fn,
+                                       particle_loglik_fn loglik_fn,
+                                       void *ctx,
+                                       uint64_t seed);
+error_t particle_filter_del(particle_filter_t *pf);
+
+/* Draws every particle from a gaussian with the given mean and per
+   component standard deviation, and makes the weights uniform.
+*/
+error_t particle_filter_init_gaussian(particle_filter_t *pf, v_t *mean, v_t *std);
+
+/* Propagates every particle by dt with propagate_fn. */
+error_t particle_filter_predict(particle_filter_t *pf, float dt, v_t *cur_ctrl);
+
+/* Reweights every particle by loglik_fn for meas and renormalizes the log
+   weights with log-sum-exp.  Returns E_ERR if every weight underflowed.
+   The weights are left untouched if loglik_fn fails on any chunk or every
+   weight underflowed.
+*/
+error_t particle_filter_update(particle_filter_t *pf, v_t *meas);
+
+/* Returns the effective sample size, 1/sum(w^2). */
+v_data_t particle_filter_ess(particle_filter_t *pf);
+
+/* Resamples in O(n_particles) into the second state buffer, then swaps the
+   buffers.  The weights end up uniform.
+
+   Like predict and update this works in buffers and task graphs made by
+   particle_filter_new, so it never allocates.
+*/
+error_t particle_filter_resample(particle_filter_t *pf, particle_resample_t method);
+
+/* Returns the weighted mean of the particles in mean. */
+error_t particle_filter_mean(particle_filter_t *pf, v_t *mean);
+
+#endif /* __FILTERING_PARTICLE_H__ */
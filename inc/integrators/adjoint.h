@@ -0,0 +1,96 @@
+#ifndef __INTEGRATOR_ADJOINT_H_60418275__
+#define __INTEGRATOR_ADJOINT_H_60418275__
+
+#include "errors.h"
+#include "data_structures/vector.h"
+#include "integrators/integrator.h"
+
+/* A state_vjp_fn is the reverse mode counterpart of a state_fn.  Given the
+   same state and control and a vector lambda the length of the state, it
+   calculates the vector-Jacobian products
+       st_bar = (df/dst)^T lambda    ctrl_bar = (df/dctrl)^T lambda
+   ctrl_bar is NULL when there is no control.
+*/
+typedef error_t (*state_vjp_fn)(
+                                v_t *cur_st,
+                                v_t *cur_ctrl,
+                                v_t *lambda,
+                                v_t *st_bar,
+                                v_t *ctrl_bar
+                                );
+
+/* A terminal_grad_fn calculates the gradient of a cost J(final_st) with
+   respect to the final state.
+*/
+typedef error_t (*terminal_grad_fn)(
+                                    v_t *final_st,
+                                    v_t *grad
+                                    );
+
+typedef struct integrator_adjoint {
+    state_fn fn;
+    state_vjp_fn vjp_fn;
+
+    /* Number of states that are kept around while running backwards.  This
+       is the memory/recomputation trade-off: with s checkpoints and N steps
+       each step is recomputed about t times, where t is the smallest with
+       (s+1+t choose t) >= N.  0 recomputes the whole prefix for every step.
+       Around log2(N) checkpoints keep both memory and recomputation
+       logarithmic.
+    */
+    size_t n_checkpoints;
+
+    /* Total RK4 steps taken forwards by the last run, including the ones
+       that were recomputed.  Useful for tuning n_checkpoints.
+    */
+    size_t n_forward_steps;
+
+    // Any of the fields with leading underscores are internal scratch pad values that you
+    // should not touch.
+    v_data_t *_checkpoints;
+    v_t *_w0;
+    v_t *_w1;
+    v_t *_k[3];
+    v_t *_y;
+    v_t *_kbar;
+    v_t *_ybar;
+    v_t *_xbar;
+    v_t *_ubar;
+} integrator_adjoint_t;
+
+/* Returns a new adjoint context for states of length st_len and controls of
+   length ctrl_len (which may be 0 for no control), keeping at most
+   n_checkpoints states.
+*/
+integrator_adjoint_t* integrator_adjoint_new(state_fn fn, state_vjp_fn vjp_fn,
+                                             size_t st_len, size_t ctrl_len, size_t n_checkpoints);
+error_t integrator_adjoint_del(integrator_adjoint_t *adj);
+
+/* Integrates n_steps fixed RK4 steps of dt from init_st with the control
+   held constant and returns the gradient of the terminal cost with respect
+   to the initial state in st_grad and with respect to the control in
+   ctrl_grad.  The control plays the part of the model parameters.
+   final_st gets the final state if it isn't NULL.  cur_ctrl and ctrl_grad
+   must be NULL if the context has no control.
+
+   The gradients are those of the discrete RK4 map (discretize, then
+   differentiate), so they match finite differences of integrator_rk4 runs.
+
+   Only the n_checkpoints states are stored.  The steps between them are
+   recomputed during the backward sweep following the binomial schedule of
+   Griewank & Walther's revolve, which needs the fewest recomputations
+   possible for that much memory.
+
+   See: A. Griewank & A. Walther, Algorithm 799: Revolve, ACM TOMS 26(1), 2000
+*/
+error_t integrator_adjoint_rk4(integrator_adjoint_t *adj,
+                               terminal_grad_fn grad_fn,
+                               float dt,
+                               size_t n_steps,
+                               v_t *init_st,
+                               v_t *cur_ctrl,
+                               v_t *final_st,
+                               v_t *st_grad,
+                               v_t *ctrl_grad);
+
+#endif /* __INTEGRATOR_ADJOINT_H_60418275__ */
@@ -0,0 +1,88 @@
+#ifndef __INTEGRATOR_EVENTS_H_77123412__
+#define __INTEGRATOR_EVENTS_H_77123412__
+
+#include <stdbool.h>
+
+#include "errors.h"
+#include "data_structures/vector.h"
+#include "integrators/integrator.h"
+
+/* An event_fn calculates g(state, control).  An event happens wherever g
+   crosses zero (ground contact, a mode switch, ...).
+*/
+typedef error_t (*event_fn)(
+                            v_t *cur_st,
+                            v_t *cur_ctrl,
+                            v_data_t *val
+                            );
+
+typedef enum integrator_event_dir {
+    EVENT_FALLING = -1, /* Only crossings where g goes from + to - */
+    EVENT_ANY     =  0,
+    EVENT_RISING  =  1, /* Only crossings where g goes from - to + */
+} integrator_event_dir_t;
+
+typedef struct integrator_event {
+    event_fn fn;
+    integrator_event_dir_t direction;
+    /* A terminal event cuts the step short at the crossing. */
+    bool terminal;
+
+    /* Set by integrator_events_step.  fired is true if the event happened
+       during the step and t is how far into the step (in time) it happened.
+    */
+    bool fired;
+    float t;
+} integrator_event_t;
+
+typedef struct integrator_events {
+    integrator_event_t *events;
+    size_t n_events;
+
+    /* Crossings are localized to within tol (in time).  Defaults to 1e-9. */
+    double tol;
+
+    // Any of the fields with leading underscores are internal scratch pad values that you
+    // should not touch.
+    v_t *_f0;
+    v_t *_f1;
+    v_t *_interp;
+    v_data_t *_g0;
+    v_data_t *_g1;
+} integrator_events_t;
+
+/* Returns a new event context watching the n_events events in events for a
+   state of length st_len.  The events array is not copied and must outlive
+   the context.
+*/
+integrator_events_t* integrator_events_new(integrator_event_t *events, size_t n_events, size_t st_len);
+error_t integrator_events_del(integrator_events_t *ev);
+
+/* Takes one step of int_fn from cur_st into next_st while watching for events.
+
+   Each event's g is evaluated at both ends of the step.  Only if one of them
+   changed sign (in an allowed direction) is the step's interpolant built: a
+   cubic Hermite through both ends and their rates, which costs two extra
+   state_fn calls.  The crossing is then found on the interpolant with the
+   Illinois variant of regula falsi.  Steps without events cost nothing extra
+   beyond the g evaluations.
+
+   If a terminal event fires, next_st is the interpolated state just past the
+   earliest terminal crossing (so g already has its new sign there) and
+   *terminated is set.  Otherwise next_st is the full step.  Either way
+   *dt_taken is the time actually advanced.  Non-terminal events that happen
+   before the end of the (possibly shortened) step are marked fired.
+
+   next_st must be a different vector than cur_st.
+*/
+error_t integrator_events_step(integrator_events_t *ev,
+                               integrator_fn int_fn,
+                               state_fn fn,
+                               float dt,
+                               v_t *cur_st,
+                               v_t *cur_ctrl,
+                               v_t *next_st,
+                               float *dt_taken,
+                               bool *terminated);
+
+#endif /* __INTEGRATOR_EVENTS_H_77123412__ */
@@ -26,10 +26,45 @@ typedef error_t (*integrator_fn)(
                                 v_t *cur_st_rate
                                 );
 
+/* An accel_fn is the split counterpart of a state_fn for second order systems
+   q'' = a(q, u), like conservative mechanical and orbital models.  It takes a
+   position and a control and calculates the corresponding acceleration.  The
+   acceleration must not depend on velocity for the symplectic integrators to
+   stay symplectic.
+*/
+typedef error_t (*accel_fn)(
+                            v_t *cur_pos,
+                            v_t *cur_ctrl,
+                            v_t *cur_accel
+                            );
+
+/* split_integrator_fns take an acceleration function and advance a position
+   and velocity in place by dt.
+*/
+typedef error_t (*split_integrator_fn)(
+                                      accel_fn fn,
+                                      float    dt,
+                                      v_t *pos,
+                                      v_t *vel,
+                                      v_t *cur_ctrl
+                                      );
+
 typedef struct integrator {
     integrator_fn int_fn;
 } integrator_t;
 
 integrator_t* integrator_new(integrator_fn int_fn);
+error_t integrator_del(integrator_t *integrator);
+
+/****
+ * Fixed step integrator_fns.  For all of these next_st must be a different
+ * vector than cur_st and all of the state vectors must be the same length.
+ ****/
+
+/* Forward Euler: next = cur + dt*f(cur) */
+error_t integrator_euler(state_fn fn, float dt, v_t *cur_st, v_t *cur_ctrl, v_t *next_st);
+
+/* Classic 4th order Runge-Kutta.  Stage storage lives on the stack. */
+error_t integrator_rk4(state_fn fn, float dt, v_t *cur_st, v_t *cur_ctrl, v_t *next_st);
 
 #endif /* __INTEGRATOR_H_29948585__ */
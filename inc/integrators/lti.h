@@ -0,0 +1,72 @@
+#ifndef __INTEGRATOR_LTI_H_38120597__
+#define __INTEGRATOR_LTI_H_38120597__
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "errors.h"
+#include "data_structures/matrix.h"
+#include "data_structures/vector.h"
+
+/* Exact discretization of linear time-invariant segments
+       x' = A x + B u + w,    E[w w^T] = Qc
+   held over a step of dt with u constant, which gives
+       x_next = Phi x + Gamma u + w_d,    E[w_d w_d^T] = Qd
+
+   For a linear plant this replaces an integrator_fn and its state_fn calls
+   with one matrix-vector multiply-add per step.
+*/
+
+typedef struct lti_discrete {
+    float dt;
+    m_t *Phi;   /* n_states x n_states */
+    m_t *Gamma; /* n_states x n_ctrl, NULL without a control */
+    m_t *Qd;    /* n_states x n_states, NULL without process noise */
+
+    // Any of the fields with leading underscores are internal scratch pad values that you
+    // should not touch.
+    m_t *_work;
+} lti_discrete_t;
+
+/* Returns a new discretization for n_states states and n_ctrl controls
+   (which may be 0).  Qd is only allocated if noise is true.
+*/
+lti_discrete_t* lti_discrete_new(size_t n_states, size_t n_ctrl, bool noise);
+error_t lti_discrete_del(lti_discrete_t *disc);
+
+/* Discretizes A, B and Qc over dt into disc using Van Loan's block matrix
+   exponentials:
+       e^([A B; 0 0] dt)      = [Phi Gamma; 0 I]
+       e^([-A Qc; 0 A^T] dt)  = [. F12; 0 Phi^T],    Qd = Phi F12
+   B must be NULL if disc has no Gamma and Qc NULL if it has no Qd.
+
+   See: C. Van Loan, Computing Integrals Involving the Matrix Exponential,
+        IEEE Trans. Automatic Control 23(3), 1978
+*/
+error_t lti_discretize(m_t *A, m_t *B, m_t *Qc, float dt, lti_discrete_t *disc);
+
+/* next_st = Phi cur_st + Gamma cur_ctrl.  cur_ctrl is ignored without a
+   Gamma.  next_st must be a different vector than cur_st.
+*/
+error_t lti_step(lti_discrete_t *disc, v_t *cur_st, v_t *cur_ctrl, v_t *next_st);
+
+/* A small cache of discretizations keyed on the contents of (A, B, Qc, dt),
+   so a segment only pays for its matrix exponentials the first time it is
+   seen.  When it is full the oldest entry is replaced.
+*/
+typedef struct lti_cache lti_cache_t;
+
+/* Returns a new cache holding up to capacity discretizations for n_states
+   states and n_ctrl controls.  noise says whether lookups come with a Qc.
+*/
+lti_cache_t* lti_cache_new(size_t n_states, size_t n_ctrl, bool noise, size_t capacity);
+error_t lti_cache_del(lti_cache_t *cache);
+
+/* Points *disc at the discretization of (A, B, Qc, dt), computing it if it
+   isn't cached yet.  B and Qc must be given exactly when the cache was made
+   with controls and noise.  *disc belongs to the cache and stays valid until
+   capacity further distinct segments have been looked up.
+*/
+error_t lti_cache_get(lti_cache_t *cache, m_t *A, m_t *B, m_t *Qc, float dt, lti_discrete_t **disc);
+
+#endif /* __INTEGRATOR_LTI_H_38120597__ */
@@ -0,0 +1,73 @@
+#ifndef __INTEGRATOR_SYMPLECTIC_H_31887410__
+#define __INTEGRATOR_SYMPLECTIC_H_31887410__
+
+#include <stdlib.h>
+
+#include "errors.h"
+#include "data_structures/vector.h"
+#include "integrators/integrator.h"
+
+/****
+ * Symplectic split_integrator_fns for q'' = a(q, u).
+ *
+ * These conserve a shadow Hamiltonian, so energy error stays bounded over
+ * long runs instead of drifting like it does with the RK family.  All of
+ * them update pos and vel in place and keep their only scratch vector (the
+ * acceleration) on the stack or in a stepper made up front, so stepping
+ * never allocates.
+ *
+ * pos and vel must be the same length.
+ ****/
+
+/* Velocity Verlet (kick-drift-kick leapfrog).  2nd order, 2 accel_fn calls. */
+error_t integrator_velocity_verlet(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl);
+
+/* Velocity Verlet that keeps the end-of-step acceleration for the next step,
+   so a run of steps costs 1 accel_fn call each instead of 2.
+
+   The kept acceleration goes stale whenever the caller changes the state
+   between steps.  Each step compares fn, pos and the contents of cur_ctrl
+   with what the last step ended with and re-evaluates if any differ, so
+   editing pos or the control needs nothing extra.  The stepper can't see
+   anything else fn depends on (a context it reads through a global, a
+   parameter it looks up), so after changing that call
+   integrator_verlet_reset.  Gives bit-identical results to
+   integrator_velocity_verlet.
+*/
+typedef struct integrator_verlet integrator_verlet_t;
+
+/* Returns a new Verlet stepper for len positions and ctrl_len controls, or
+   NULL.  ctrl_len may be 0 if steps are given no control.
+*/
+integrator_verlet_t* integrator_verlet_new(size_t len, size_t ctrl_len);
+error_t integrator_verlet_del(integrator_verlet_t *v);
+
+error_t integrator_verlet_step(integrator_verlet_t *v, accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl);
+
+/* Drops the kept acceleration so the next step evaluates fn afresh. */
+error_t integrator_verlet_reset(integrator_verlet_t *v);
+
+/* Yoshida's 4th order triple jump.  3 accel_fn calls. */
+error_t integrator_yoshida4(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl);
+
+/* Suzuki's 4th order 5 stage fractal.  More calls than yoshida4 but a much
+   smaller error constant, since it avoids the large negative substep.
+   5 accel_fn calls.
+*/
+error_t integrator_suzuki4(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl);
+
+/* Yoshida's 6th order 7 stage method (his "solution A").  7 accel_fn calls. */
+error_t integrator_yoshida6(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl);
+
+/* Generic symmetric composition of drift-kick-drift leapfrog substeps.
+
+   Takes one substep of w[i]*dt for each of the n_weights weights, merging
+   neighbouring half drifts, so it costs n_weights accel_fn calls.  The
+   weights must sum to 1 and should be palindromic to keep the method
+   time-reversible.  All of the methods above except Verlet are this with a
+   fixed set of weights.
+*/
+error_t integrator_composition(const double *w, size_t n_weights,
+                               accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl);
+
+#endif /* __INTEGRATOR_SYMPLECTIC_H_31887410__ */
@@ -0,0 +1,30 @@
+#ifndef __LINEAR_ALGEBRA_BATCH__
+#define __LINEAR_ALGEBRA_BATCH__
+
+#include "errors.h"
+#include "data_structures/matrix_batch.h"
+
+/* Batched counterparts of the decompositions for many small independent
+ * problems, like one covariance per tracked object.  See matrix_batch.h for
+ * the interleaved storage they work on.
+ *
+ * Nothing is checked per matrix.  A matrix in the batch that is not positive
+ * definite just ends up with NaNs in its own results; the rest of the batch
+ * is unaffected.
+ */
+
+/* Computes the lower triangular Cholesky factor L of every matrix in A, so
+ * that A[b] = L[b]L[b]^T.  Only the lower triangle of A is read.
+ *
+ * It is alright for L to be the same as A.
+ */
+error_t la_batch_cholesky(m_batch_t* A, m_batch_t* L);
+
+/* Solves A[b]X[b] = B[b] for every matrix in the batch, given the Cholesky
+ * factors L of A from la_batch_cholesky.  B can have any number of columns.
+ *
+ * It is alright for X to be the same as B.
+ */
+error_t la_batch_cholesky_solve(m_batch_t* L, m_batch_t* B, m_batch_t* X);
+
+#endif /* __LINEAR_ALGEBRA_BATCH__ */
@@ -1,8 +1,11 @@
 #ifndef __LINEAR_ALGEBRA_DECOMPOSITONS__
 #define __LINEAR_ALGEBRA_DECOMPOSITONS__
 
+#include <stdbool.h>
+
 #include "errors.h"
 #include "data_structures/matrix.h"
+#include "data_structures/vector.h"
 
 /* Returns the lower triangular matrix (L) of the Cholesky decomposition.  The full
  * decomposition is A = LL* where L* is the conjugate transpose of L.
@@ -22,4 +25,28 @@ error_t la_decompositions_qr(m_t* A, m_t* Q, m_t* R);
 
 /* Returns Q where the columns of Q are the orthonormal vectors obtained by carrying out the Gram-Schmidt process on A */
 error_t la_decomopositions_gram_schmidt(m_t* A, m_t* Q);
+
+/* Returns the eigenvalues of A in w, in ascending order.  If V is not NULL the
+ * matching orthonormal eigenvectors are returned as the columns of V.
+ *
+ * A must be square and symmetric.  w must be as long as A and V the same size.
+ * Passing a NULL V takes a faster path that never forms the eigenvectors.
+ *
+ * A is reduced to tridiagonal form with Householder reflections and the
+ * tridiagonal matrix is diagonalized with implicit Wilkinson-shift QR.
+ *
+ * See: Golub & Van Loan, Matrix Computations, sections 8.3.1 - 8.3.3
+ */
+error_t la_decompositions_symmetric_eigen(m_t* A, v_t* w, m_t* V);
+
+/* Returns only the k smallest (or, if largest is true, the k largest)
+ * eigenvalues of A in w, most extreme first.  If V is not NULL the matching
+ * eigenvectors are returned as the columns of V, which must be A->rows x k.
+ *
+ * A must be square and symmetric.  The eigenvalues come from the fast
+ * eigenvalues-only path and just the k requested eigenvectors are found by
+ * inverse iteration on the tridiagonal matrix, which is much cheaper than the
+ * full decomposition when k is small.
+ */
+error_t la_decompositions_symmetric_eigen_extreme(m_t* A, size_t k, bool largest, v_t* w, m_t* V);
 #endif /* __LINEAR_ALGEBRA_DECOMPOSITONS__ */
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef __LINEAR_ALGEBRA_EXPONENTIAL__
+#define __LINEAR_ALGEBRA_EXPONENTIAL__
+
+#include "errors.h"
+#include "data_structures/matrix.h"
+
+/* Returns E = e^A for a square A.  E must be the same size as A and may be A.
+ *
+ * Uses scaling and squaring with the diagonal Pade approximant of degree 3,
+ * 5, 7, 9 or 13, whichever is the cheapest to reach double precision for
+ * the 1-norm of A.
+ *
+ * See: N. Higham, The Scaling and Squaring Method for the Matrix Exponential
+ *      Revisited, SIAM J. Matrix Anal. Appl. 26(4), 2005
+ */
+error_t la_expm(m_t* A, m_t* E);
+
+#endif /* __LINEAR_ALGEBRA_EXPONENTIAL__ */
@@ -0,0 +1,118 @@
+#ifndef __LOGGING_TRAJECTORY_LOG_H__
+#define __LOGGING_TRAJECTORY_LOG_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "errors.h"
+#include "data_structures/matrix.h"
+#include "data_structures/vector.h"
+
+/* Binary trajectory logs.
+
+   A log is a fixed size header followed by fixed size records.  Every record
+   is the time followed by the state and then the covariance (row-major), all
+   stored as the header's dtype in native byte order.  Because every record is
+   the same size, record i lives at
+       TRAJ_LOG_HEADER_SIZE + i*record_size
+   and a log can be scanned without parsing anything.
+*/
+
+#define TRAJ_LOG_MAGIC "DYNTRAJ"
+#define TRAJ_LOG_VERSION 1u
+#define TRAJ_LOG_HEADER_SIZE 64u
+/* Written as-is, so a reader on a machine with the other byte order sees it swapped. */
+#define TRAJ_LOG_BYTE_ORDER 0x01020304u
+
+typedef enum traj_log_dtype {
+    TRAJ_LOG_F32 = 1,
+    TRAJ_LOG_F64 = 2,
+} traj_log_dtype_t;
+
+typedef struct traj_log_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t dtype;
+    uint32_t _reserved;
+    uint64_t state_len;
+    uint64_t cov_rows;
+    uint64_t cov_cols;
+    /* Size in bytes of one record, including the time stamp. */
+    uint64_t record_size;
+    /* Only every decimation'th pushed snapshot made it into the log. */
+    uint64_t decimation;
+} traj_log_header_t;
+
+/****
+ * Writing.
+ *
+ * traj_log_writer_push copies a snapshot into a lock-free single-producer
+ * single-consumer ring buffer and returns right away.  A background thread
+ * drains the ring to disk.  Only one thread may push to a given writer.
+ ****/
+typedef struct traj_log_writer traj_log_writer_t;
+
+/* Creates (truncating) the log at path and starts its writer thread.
+
+   cov_rows and cov_cols can both be 0 to log the state only.  ring_len is the
+   number of records the ring buffer can hold and is rounded up to a power of
+   two.  With a decimation of N only every Nth pushed snapshot is logged; 0
+   and 1 both mean log everything.
+*/
+traj_log_writer_t* traj_log_writer_new(const char *path,
+                                       size_t state_len,
+                                       size_t cov_rows,
+                                       size_t cov_cols,
+                                       size_t ring_len,
+                                       size_t decimation);
+
+/* Queues a snapshot of st and cov taken at time t.
+
+   cov is ignored (and may be NULL) if the log has no covariance.  If the
+   ring buffer is full the snapshot is dropped instead of stalling the
+   caller; see traj_log_writer_dropped.
+*/
+error_t traj_log_writer_push(traj_log_writer_t *w, double t, v_t *st, m_t *cov);
+
+/* Number of snapshots dropped so far because the ring buffer was full. */
+size_t traj_log_writer_dropped(const traj_log_writer_t *w);
+
+/* Drains everything still queued, stops the writer thread, closes the file
+   and frees the writer.  Returns E_ERR if any write to disk failed.
+*/
+error_t traj_log_writer_close(traj_log_writer_t *w);
+
+/****
+ * Reading.
+ *
+ * The log is memory-mapped read-only and records are handed back as views
+ * into the mapping.  Nothing is copied.
+ ****/
+typedef struct traj_log_reader traj_log_reader_t;
+
+/* A view of one record.  state and cov point straight into the mapped file.
+   They are only valid until the reader is closed, must not be written to,
+   and must NOT be passed to v_del or m_del.
+*/
+typedef struct traj_log_record {
+    double t;
+    v_t state;
+    m_t cov;
+} traj_log_record_t;
+
+/* Maps the log at path.  Returns NULL if it can't be opened, isn't a log,
+   or was written with a dtype or byte order this build can't view directly.
+*/
+traj_log_reader_t* traj_log_reader_open(const char *path);
+error_t traj_log_reader_close(traj_log_reader_t *r);
+
+const traj_log_header_t* traj_log_reader_header(const traj_log_reader_t *r);
+
+/* Number of complete records in the log. */
+size_t traj_log_reader_len(const traj_log_reader_t *r);
+
+/* Fills rec with a view of record idx. */
+error_t traj_log_reader_record(const traj_log_reader_t *r, size_t idx, traj_log_record_t *rec);
+
+#endif /* __LOGGING_TRAJECTORY_LOG_H__ */
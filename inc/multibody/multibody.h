@@ -0,0 +1,79 @@
+#ifndef __MULTIBODY_H_51724433__
+#define __MULTIBODY_H_51724433__
+
+#include <stdlib.h>
+
+#include "errors.h"
+#include "data_structures/vector.h"
+
+/* Forward dynamics of a kinematic tree of rigid bodies with Featherstone's
+   articulated-body algorithm, which costs O(n) in the number of bodies
+   instead of the O(n^3) of building and solving the joint space mass matrix.
+
+   Each body hangs off one single degree of freedom joint, so the tree has as
+   many joint coordinates as it has bodies.  Spatial vectors are 6D with the
+   angular part first, as in Featherstone's Rigid Body Dynamics Algorithms.
+
+   See: R. Featherstone, Rigid Body Dynamics Algorithms, chapter 7
+*/
+
+/* Parent of the bodies attached directly to the fixed base. */
+#define MULTIBODY_BASE ((size_t)-1)
+
+typedef enum multibody_joint {
+    MULTIBODY_REVOLUTE,  /* Rotation of q radians about axis */
+    MULTIBODY_PRISMATIC, /* Translation of q along axis */
+} multibody_joint_t;
+
+typedef struct multibody_body {
+    /* Index of the parent body, which must come before this one, or
+       MULTIBODY_BASE.
+    */
+    size_t parent;
+
+    multibody_joint_t joint;
+    /* Unit joint axis in the body frame. */
+    v_data_t axis[3];
+
+    /* The joint frame at q = 0 relative to the parent's frame: rot is the
+       3x3 row-major rotation taking parent coordinates to body coordinates
+       and pos is the body origin in parent coordinates.
+    */
+    v_data_t rot[9];
+    v_data_t pos[3];
+
+    /* Mass, center of mass in the body frame, and the 3x3 row-major
+       rotational inertia about the center of mass.
+    */
+    v_data_t mass;
+    v_data_t com[3];
+    v_data_t inertia[9];
+} multibody_body_t;
+
+typedef struct multibody multibody_t;
+
+/* Returns a new model of the n_bodies bodies, which are copied.  gravity is
+   the gravitational acceleration in base coordinates, e.g. {0, 0, -9.81}.
+   All of the per-body scratch the algorithm needs is allocated here.
+*/
+multibody_t* multibody_new(const multibody_body_t *bodies, size_t n_bodies, const v_data_t gravity[3]);
+error_t multibody_del(multibody_t *model);
+
+/* Returns the number of joint coordinates (and bodies) of the model. */
+size_t multibody_dof(const multibody_t *model);
+
+/* Calculates the joint accelerations qdd for joint positions q, velocities
+   qd and forces/torques tau, all of length multibody_dof.  tau may be NULL
+   for no applied forces.  A model must only be used by one thread at a time.
+*/
+error_t multibody_forward_dynamics(multibody_t *model, v_t *q, v_t *qd, v_t *tau, v_t *qdd);
+
+/* Makes model the one multibody_state_fn uses on the calling thread. */
+error_t multibody_bind(multibody_t *model);
+
+/* A state_fn for the bound model.  The state is [q; qd] and the control is
+   tau (or NULL), so the state rate is [qd; qdd].
+*/
+error_t multibody_state_fn(v_t *cur_st, v_t *cur_ctrl, v_t *cur_st_rate);
+
+#endif /* __MULTIBODY_H_51724433__ */
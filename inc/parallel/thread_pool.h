@@ -0,0 +1,57 @@
+#ifndef __PARALLEL_THREAD_POOL_H__8181818
+#define __PARALLEL_THREAD_POOL_H__8181818
+
+#include <stdlib.h>
+
+#include "errors.h"
+
+/* A small pthread pool shared by the parallel kernels (m_mult, the blocked
+   decompositions, ...).
+
+   Work is handed to the pool as a graph of tasks with dependencies between
+   them.  A task only runs once everything it depends on has finished, and
+   tasks never share output, so results do not depend on how many threads
+   there are or how the tasks happen to get scheduled.
+
+   Kernels called from inside a task run serially rather than trying to use
+   the pool again.
+*/
+
+/* Sets the number of threads the pool uses, counting the calling thread.
+   0 means one per online CPU (the default) and 1 runs everything on the
+   calling thread.  Must not be called while a parallel kernel is running.
+*/
+error_t parallel_set_threads(size_t n_threads);
+
+/* Returns the number of threads the pool will use. */
+size_t parallel_get_threads(void);
+
+/* A task gets the shared context of its graph and the two indices it was
+   added with, which is usually enough to identify a tile or block.
+*/
+typedef void (*parallel_task_fn)(void *ctx, size_t i, size_t j);
+
+typedef struct parallel_graph parallel_graph_t;
+
+/* Returns a new, empty task graph whose tasks all get ctx. */
+parallel_graph_t* parallel_graph_new(void *ctx);
+error_t parallel_graph_del(parallel_graph_t *g);
+
+/* Adds a task running fn(ctx, i, j).  If id is not NULL it gets the task's
+   id for use with parallel_graph_depend.
+*/
+error_t parallel_graph_add(parallel_graph_t *g, parallel_task_fn fn, size_t i, size_t j, size_t *id);
+
+/* Makes task wait for on to finish before it starts.  on must have been
+   added before task, which keeps graphs acyclic.
+*/
+error_t parallel_graph_depend(parallel_graph_t *g, size_t task, size_t on);
+
+/* Runs every task in the graph and returns once they have all finished.
+   A graph can be run as many times as you like.  Running never allocates
+   beyond starting the pool's threads the first time they are needed, so a
+   graph built once can be rerun cheaply.
+*/
+error_t parallel_graph_run(parallel_graph_t *g);
+
+#endif /* __PARALLEL_THREAD_POOL_H__8181818 */
@@ -1,13 +1,21 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include "data_structures/matrix.h"
+#include "parallel/thread_pool.h"
 
 m_t* m_new(size_t rows, size_t cols)
+{
+    return m_new_ordered(rows, cols, M_ROW_MAJOR);
+}
+
+m_t* m_new_ordered(size_t rows, size_t cols, m_order_t order)
 {
     m_t *nm = NULL;
     m_data_t *d = NULL;
     if (rows <= 0) goto fail;
     if (cols <= 0) goto fail;
+    if (order != M_ROW_MAJOR && order != M_COL_MAJOR) goto fail;
 
     nm = malloc(sizeof *nm);
     if (!nm) goto fail_nm;
@@ -17,6 +25,7 @@ m_t* m_new(size_t rows, size_t cols)
 
     nm->rows = rows;
     nm->cols = cols;
+    nm->order = order;
     nm->data = d;
     goto out;
 
@@ -39,14 +48,32 @@ error_t m_del(m_t *m)
     return E_OK;
 }
 
-/* Unsafe - does no checks.  Make sure you have your stuff right!
+error_t m_init_view(m_t *mat, size_t rows, size_t cols, m_order_t order, m_data_t *data)
+{
+    if (!mat || !data) return E_NULLP;
+    if (!rows || !cols) return E_VAL;
+    if (order != M_ROW_MAJOR && order != M_COL_MAJOR) return E_VAL;
 
-    For now store as rows because this makes sense for multiplying
-    by vectors.
-*/
+    mat->rows = rows;
+    mat->cols = cols;
+    mat->order = order;
+    mat->data = data;
+
+    return E_OK;
+}
+
+/* Unsafe - does no checks.  Make sure you have your stuff right! */
 static inline size_t m_get_index(m_t *mat, size_t m, size_t n)
 {
-    return mat->data[m*mat->cols+n];
+    return m*m_row_stride(mat) + n*m_col_stride(mat);
+}
+
+/* Returns true if all the matricies given share one storage order, in which
+   case element-wise operations can just walk their data front to back.
+*/
+static inline bool m_same_order(m_t *a, m_t *b, m_t *c)
+{
+    return a->order == b->order && b->order == c->order;
 }
 
 error_t m_set(m_t *mat, size_t m, size_t n, m_data_t val)
@@ -69,10 +96,83 @@ m_data_t m_get(m_t *mat, size_t m, size_t n)
     return mat->data[m_get_index(mat,m,n)];
 }
 
+/* Products with fewer multiply-adds than this stay on the calling thread. */
+#define M_MULT_PARALLEL_MIN_WORK (96*96*96)
+/* Tiles of res handed out to the thread pool are at most this big a side. */
+#define M_MULT_TILE 64
+
+typedef struct m_mult_ctx {
+    m_t *lhs;
+    m_t *rhs;
+    m_t *res;
+} m_mult_ctx_t;
+
+/* Unsafe - does no checks.
+
+   Computes rows [r0, r1) and columns [c0, c1) of res.  Every entry is summed
+   over the common dimension in order no matter how res is tiled, so the
+   parallel and serial products are identical.
+*/
+static void m_mult_tile(m_mult_ctx_t *ctx, size_t r0, size_t r1, size_t c0, size_t c1)
+{
+    const size_t common_dim = ctx->lhs->cols;
+    const m_data_t *l = ctx->lhs->data;
+    const m_data_t *r = ctx->rhs->data;
+    m_data_t *res = ctx->res->data;
+    const size_t l_rs = m_row_stride(ctx->lhs), l_cs = m_col_stride(ctx->lhs);
+    const size_t r_rs = m_row_stride(ctx->rhs), r_cs = m_col_stride(ctx->rhs);
+    const size_t res_rs = m_row_stride(ctx->res), res_cs = m_col_stride(ctx->res);
+
+    /* Walk res in its own storage order so the innermost loop is contiguous
+       in res (and in lhs/rhs too when they share its order).
+    */
+    if (ctx->res->order == M_COL_MAJOR) {
+        for (size_t n=c0; n < c1; n++) {
+            m_data_t *res_col = res + n*res_cs;
+            for (size_t m=r0; m < r1; m++) {
+                res_col[m*res_rs] = 0.0;
+            }
+            for (size_t i=0; i < common_dim; i++) {
+                const m_data_t r_in = r[i*r_rs + n*r_cs];
+                const m_data_t *l_col = l + i*l_cs;
+                for (size_t m=r0; m < r1; m++) {
+                    res_col[m*res_rs] += l_col[m*l_rs]*r_in;
+                }
+            }
+        }
+        return;
+    }
+
+    for (size_t m=r0; m < r1; m++) {
+        m_data_t *res_row = res + m*res_rs;
+        for (size_t n=c0; n < c1; n++) {
+            res_row[n*res_cs] = 0.0;
+        }
+        for (size_t i=0; i < common_dim; i++) {
+            const m_data_t l_mi = l[m*l_rs + i*l_cs];
+            const m_data_t *r_row = r + i*r_rs;
+            for (size_t n=c0; n < c1; n++) {
+                res_row[n*res_cs] += l_mi*r_row[n*r_cs];
+            }
+        }
+    }
+}
+
+static void m_mult_tile_task(void *ctx, size_t ti, size_t tj)
+{
+    m_mult_ctx_t *c = ctx;
+    const size_t r0 = ti*M_MULT_TILE, c0 = tj*M_MULT_TILE;
+    const size_t r1 = r0 + M_MULT_TILE < c->res->rows ? r0 + M_MULT_TILE : c->res->rows;
+    const size_t c1 = c0 + M_MULT_TILE < c->res->cols ? c0 + M_MULT_TILE : c->res->cols;
+
+    m_mult_tile(c, r0, r1, c0, c1);
+}
+
 error_t m_mult(m_t *lhs, m_t *rhs, m_t *res)
 {
-    size_t common_dim;
-    m_data_t rc_sum;
+    m_mult_ctx_t ctx = { .lhs = lhs, .rhs = rhs, .res = res };
+    parallel_graph_t *g = NULL;
+    error_t err = E_OK;
 
     /* TODO: Better errors.  4 different failures give E_VAL! */
     if (!lhs || !rhs || !res) return E_NULLP;
@@ -81,19 +181,24 @@ error_t m_mult(m_t *lhs, m_t *rhs, m_t *res)
     if (rhs->cols != res->cols) return E_VAL;
     if (res == lhs || res == rhs) return E_VAL;
 
-    common_dim = lhs->cols;
+    if (lhs->rows*lhs->cols*rhs->cols < M_MULT_PARALLEL_MIN_WORK || parallel_get_threads() < 2) {
+        m_mult_tile(&ctx, 0, res->rows, 0, res->cols);
+        return E_OK;
+    }
+
+    g = parallel_graph_new(&ctx);
+    if (!g) return E_ERR;
 
-    for (size_t m=0; m < lhs->rows; m++) {
-        for (size_t n=0; n < rhs->cols; n++) {
-            rc_sum = 0.0;
-            for (size_t i=0; i < common_dim; i++) {
-                rc_sum += m_get(lhs, m, i)*m_get(rhs, i, n);
-            }
-            m_set(res, m, n, rc_sum);
+    for (size_t ti=0; ti*M_MULT_TILE < res->rows && err == E_OK; ti++) {
+        for (size_t tj=0; tj*M_MULT_TILE < res->cols && err == E_OK; tj++) {
+            err = parallel_graph_add(g, m_mult_tile_task, ti, tj, NULL);
         }
     }
 
-    return E_OK;
+    if (err == E_OK) err = parallel_graph_run(g);
+    parallel_graph_del(g);
+
+    return err;
 }
 
 error_t m_add(m_t *lhs, m_t *rhs, m_t *res)
@@ -103,10 +208,20 @@ error_t m_add(m_t *lhs, m_t *rhs, m_t *res)
     if (lhs->rows != rhs->rows) return E_VAL;
     if (lhs->cols != res->cols) return E_VAL;
     if (lhs->rows != res->rows) return E_VAL;
+    /* Elementwise in place is fine, but not through a different layout. */
+    if (res->data == lhs->data && lhs->order != res->order) return E_VAL;
+    if (res->data == rhs->data && rhs->order != res->order) return E_VAL;
+
+    if (m_same_order(lhs, rhs, res)) {
+        for (size_t i=0; i < res->rows*res->cols; i++) {
+            res->data[i] = lhs->data[i] + rhs->data[i];
+        }
+        return E_OK;
+    }
 
     for (size_t m=0; m < res->rows; m++) {
         for (size_t n=0; n < res->cols; n++) {
-            m_set(res, m, n, m_get(lhs,m,n)+m_get(rhs,m,n));
+            res->data[m_get_index(res,m,n)] = lhs->data[m_get_index(lhs,m,n)]+rhs->data[m_get_index(rhs,m,n)];
         }
     }
 
@@ -118,10 +233,18 @@ error_t m_negate(m_t *mat, m_t *res)
     if (!mat || !res) return E_NULLP;
     if (mat->cols != res->cols) return E_VAL;
     if (mat->rows != res->rows) return E_VAL;
+    if (res->data == mat->data && mat->order != res->order) return E_VAL;
+
+    if (m_same_order(mat, mat, res)) {
+        for (size_t i=0; i < res->rows*res->cols; i++) {
+            res->data[i] = -mat->data[i];
+        }
+        return E_OK;
+    }
 
     for (size_t m=0; m < res->rows; m++) {
         for (size_t n=0; n < res->cols; n++) {
-            m_set(res, m, n, -m_get(mat,m,n));
+            res->data[m_get_index(res,m,n)] = -mat->data[m_get_index(mat,m,n)];
         }
     }
 
@@ -138,6 +261,14 @@ error_t m_transpose(m_t *mat, m_t *res) {
         return E_VAL;
     }
 
+    /* A row-major matrix and its column-major transpose share a layout. */
+    if (mat->order != res->order) {
+        if (mat->data != res->data) {
+            memcpy(res->data, mat->data, mat->rows*mat->cols*sizeof *res->data);
+        }
+        return E_OK;
+    }
+
     for (size_t m = 0; m < mat->rows; m++) {
         for (size_t n = 0; n < mat->cols; n++) {
             m_set(res, n, m, m_get(mat, m, n));
@@ -172,10 +303,8 @@ error_t m_set_all(m_t* mat, m_data_t val) {
         return E_NULLP;
     }
 
-    for (size_t m = 0; m < mat->rows; m++) {
-        for (size_t n = 0; n < mat->cols; n++) {
-            m_set(mat, m, n, val);
-        }
+    for (size_t i = 0; i < mat->rows*mat->cols; i++) {
+        mat->data[i] = val;
     }
 
     return E_OK;
@@ -194,18 +323,22 @@ error_t m_normalize_column_l2(m_t* src, m_t* dest, size_t col_idx) {
         return E_NULLP;
     }
 
-    if (src->rows != dest->cols || src->cols - 1 < col_idx || dest->cols - 1 < col_idx) {
+    if (src->rows != dest->rows || col_idx >= src->cols || col_idx >= dest->cols) {
         return E_VAL;
     }
 
+    const size_t src_rs = m_row_stride(src), dest_rs = m_row_stride(dest);
+    const m_data_t *src_col = src->data + col_idx*m_col_stride(src);
+    m_data_t *dest_col = dest->data + col_idx*m_col_stride(dest);
+
     m_data_t col_length = 0.0;
     for (size_t m = 0; m < src->rows; m++) {
-        col_length += m_get(src, m, col_idx);
+        col_length += src_col[m*src_rs]*src_col[m*src_rs];
     }
     col_length = sqrt(col_length);
 
     for (size_t m = 0; m < src->rows; m++) {
-        m_set(dest, m, col_idx, m_get(src, m, col_idx) / col_length);
+        dest_col[m*dest_rs] = src_col[m*src_rs] / col_length;
     }
 
     return E_OK;
@@ -216,12 +349,16 @@ error_t m_copy_column(m_t* src, m_t* dest, size_t col) {
         return E_NULLP;
     }
 
-    if (!m_same_size(src, dest)) {
+    if (!m_same_size(src, dest) || col >= src->cols) {
         return E_VAL;
     }
 
+    const size_t src_rs = m_row_stride(src), dest_rs = m_row_stride(dest);
+    const m_data_t *src_col = src->data + col*m_col_stride(src);
+    m_data_t *dest_col = dest->data + col*m_col_stride(dest);
+
     for (size_t m = 0; m < src->rows; m++) {
-        m_set(dest, m, col, m_get(src, m, col));
+        dest_col[m*dest_rs] = src_col[m*src_rs];
     }
 
     return E_OK;
@@ -236,17 +373,21 @@ error_t m_column_dot_product(m_t* A, size_t a_col, m_t* B, size_t b_col, m_data_
         return E_VAL;
     }
 
-    if (a_col > A->cols - 1 || b_col > B->cols) {
+    if (a_col >= A->cols || b_col >= B->cols) {
         return E_VAL;
     }
 
+    const size_t a_rs = m_row_stride(A), b_rs = m_row_stride(B);
+    const m_data_t *a = A->data + a_col*m_col_stride(A);
+    const m_data_t *b = B->data + b_col*m_col_stride(B);
+
     m_data_t tmp_res = 0.0;
 
     for (size_t m = 0; m < A->rows; m++) {
-        tmp_res += m_get(A, m, a_col)*m_get(B, m, b_col);
+        tmp_res += a[m*a_rs]*b[m*b_rs];
     }
 
     *res = tmp_res;
 
     return E_OK;
-}
\ No newline at end of file
+}
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+
+#include "data_structures/matrix_batch.h"
+
+m_batch_t* m_batch_new(size_t rows, size_t cols, size_t count)
+{
+    m_batch_t *nb = NULL;
+    m_data_t *d = NULL;
+    if (!rows || !cols || !count) goto fail;
+
+    nb = malloc(sizeof *nb);
+    if (!nb) goto fail_nb;
+
+    d = malloc(rows*cols*count*sizeof *d);
+    if (!d) goto fail_d;
+
+    nb->rows = rows;
+    nb->cols = cols;
+    nb->count = count;
+    nb->data = d;
+    goto out;
+
+    fail_d:
+    free(nb);
+
+    fail_nb:
+    fail:
+    nb = NULL;
+
+    out:
+    return nb;
+}
+
+error_t m_batch_del(m_batch_t *batch)
+{
+    if (!batch) return E_OK;
+    if (batch->data) free(batch->data);
+    free(batch);
+    return E_OK;
+}
+
+/* Unsafe - does no checks.  Make sure you have your stuff right! */
+static inline size_t m_batch_get_index(m_batch_t *batch, size_t idx, size_t m, size_t n)
+{
+    return (m*batch->cols + n)*batch->count + idx;
+}
+
+error_t m_batch_set(m_batch_t *batch, size_t idx, size_t m, size_t n, m_data_t val)
+{
+    if (!batch) return E_NULLP;
+    if (idx >= batch->count) return E_VAL;
+    if (m >= batch->rows) return E_VAL;
+    if (n >= batch->cols) return E_VAL;
+
+    batch->data[m_batch_get_index(batch, idx, m, n)] = val;
+
+    return E_OK;
+}
+
+m_data_t m_batch_get(m_batch_t *batch, size_t idx, size_t m, size_t n)
+{
+    if (!batch) return M_NAN;
+    if (idx >= batch->count) return M_NAN;
+    if (m >= batch->rows) return M_NAN;
+    if (n >= batch->cols) return M_NAN;
+
+    return batch->data[m_batch_get_index(batch, idx, m, n)];
+}
+
+error_t m_batch_load(m_batch_t *batch, size_t idx, m_t *mat)
+{
+    if (!batch || !mat) return E_NULLP;
+    if (idx >= batch->count) return E_VAL;
+    if (batch->rows != mat->rows || batch->cols != mat->cols) return E_VAL;
+
+    for (size_t m = 0; m < mat->rows; m++) {
+        for (size_t n = 0; n < mat->cols; n++) {
+            batch->data[m_batch_get_index(batch, idx, m, n)] = m_get(mat, m, n);
+        }
+    }
+
+    return E_OK;
+}
+
+error_t m_batch_store(m_batch_t *batch, size_t idx, m_t *mat)
+{
+    if (!batch || !mat) return E_NULLP;
+    if (idx >= batch->count) return E_VAL;
+    if (batch->rows != mat->rows || batch->cols != mat->cols) return E_VAL;
+
+    for (size_t m = 0; m < mat->rows; m++) {
+        for (size_t n = 0; n < mat->cols; n++) {
+            m_set(mat, m, n, batch->data[m_batch_get_index(batch, idx, m, n)]);
+        }
+    }
+
+    return E_OK;
+}
+
+bool m_batch_same_size(m_batch_t *a, m_batch_t *b)
+{
+    return a && b && a->rows == b->rows && a->cols == b->cols && a->count == b->count;
+}
+
+error_t m_batch_mult(m_batch_t *lhs, m_batch_t *rhs, m_batch_t *res)
+{
+    if (!lhs || !rhs || !res) return E_NULLP;
+    if (lhs->cols != rhs->rows) return E_VAL;
+    if (lhs->rows != res->rows) return E_VAL;
+    if (rhs->cols != res->cols) return E_VAL;
+    if (lhs->count != rhs->count || lhs->count != res->count) return E_VAL;
+    if (res->data == lhs->data || res->data == rhs->data) return E_VAL;
+
+    const size_t count = res->count;
+    const size_t common_dim = lhs->cols;
+
+    for (size_t m = 0; m < res->rows; m++) {
+        for (size_t n = 0; n < res->cols; n++) {
+            m_data_t * restrict r = res->data + (m*res->cols + n)*count;
+
+            for (size_t b = 0; b < count; b++) {
+                r[b] = 0.0;
+            }
+
+            for (size_t i = 0; i < common_dim; i++) {
+                const m_data_t * restrict l = lhs->data + (m*lhs->cols + i)*count;
+                const m_data_t * restrict x = rhs->data + (i*rhs->cols + n)*count;
+                for (size_t b = 0; b < count; b++) {
+                    r[b] += l[b]*x[b];
+                }
+            }
+        }
+    }
+
+    return E_OK;
+}
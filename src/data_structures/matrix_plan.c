@@ -0,0 +1,365 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data_structures/matrix_plan.h"
+
+struct m_plan_op;
+
+/* Kernels are picked when an op is recorded and do no checking of their own. */
+typedef void (*m_plan_kernel)(const struct m_plan_op *op);
+
+typedef struct m_plan_op {
+    m_plan_kernel kernel;
+    const m_data_t *a;
+    const m_data_t *b;
+    m_data_t *res;
+    size_t rows;
+    size_t cols;
+    size_t inner;
+
+    /* Row and column strides of each operand, see m_row_stride. */
+    size_t a_rs, a_cs;
+    size_t b_rs, b_cs;
+    size_t res_rs, res_cs;
+} m_plan_op_t;
+
+struct m_plan {
+    m_plan_op_t *ops;
+    size_t n_ops;
+    size_t ops_cap;
+
+    m_data_t *workspace;
+    size_t workspace_len;
+    size_t workspace_used;
+
+    m_t **scratch;
+    size_t n_scratch;
+};
+
+/****
+ * Kernels.  These walk the raw data directly using the strides captured at
+ * record time, and the contiguous special cases are picked at record time
+ * when every operand shares a storage order.
+ ****/
+
+static void m_plan_kernel_mult(const m_plan_op_t *op)
+{
+    for (size_t m = 0; m < op->rows; m++) {
+        for (size_t n = 0; n < op->cols; n++) {
+            m_data_t rc_sum = 0.0;
+            for (size_t i = 0; i < op->inner; i++) {
+                rc_sum += op->a[m*op->a_rs+i*op->a_cs]*op->b[i*op->b_rs+n*op->b_cs];
+            }
+            op->res[m*op->res_rs+n*op->res_cs] = rc_sum;
+        }
+    }
+}
+
+/* The small square row-major cases show up all the time in filters (3x3
+   attitude, 4x4 quaternion, ...).  Fixing the size lets the compiler fully
+   unroll them.
+*/
+#define M_PLAN_KERNEL_MULT_SQUARE(N) \
+    static void m_plan_kernel_mult_##N(const m_plan_op_t *op) \
+    { \
+        const m_data_t *a = op->a; \
+        const m_data_t *b = op->b; \
+        m_data_t *res = op->res; \
+        for (size_t m = 0; m < N; m++) { \
+            for (size_t n = 0; n < N; n++) { \
+                m_data_t rc_sum = 0.0; \
+                for (size_t i = 0; i < N; i++) { \
+                    rc_sum += a[m*N+i]*b[i*N+n]; \
+                } \
+                res[m*N+n] = rc_sum; \
+            } \
+        } \
+    }
+
+M_PLAN_KERNEL_MULT_SQUARE(2)
+M_PLAN_KERNEL_MULT_SQUARE(3)
+M_PLAN_KERNEL_MULT_SQUARE(4)
+
+/* res = a*b where b and res are vectors with strides b_rs and res_rs. */
+static void m_plan_kernel_mult_vector(const m_plan_op_t *op)
+{
+    for (size_t m = 0; m < op->rows; m++) {
+        m_data_t r_sum = 0.0;
+        for (size_t i = 0; i < op->inner; i++) {
+            r_sum += op->a[m*op->a_rs+i*op->a_cs]*op->b[i*op->b_rs];
+        }
+        op->res[m*op->res_rs] = r_sum;
+    }
+}
+
+static void m_plan_kernel_add(const m_plan_op_t *op)
+{
+    const size_t len = op->rows*op->cols;
+    for (size_t i = 0; i < len; i++) {
+        op->res[i] = op->a[i] + op->b[i];
+    }
+}
+
+static void m_plan_kernel_add_strided(const m_plan_op_t *op)
+{
+    for (size_t m = 0; m < op->rows; m++) {
+        for (size_t n = 0; n < op->cols; n++) {
+            op->res[m*op->res_rs+n*op->res_cs] = op->a[m*op->a_rs+n*op->a_cs] + op->b[m*op->b_rs+n*op->b_cs];
+        }
+    }
+}
+
+static void m_plan_kernel_negate(const m_plan_op_t *op)
+{
+    const size_t len = op->rows*op->cols;
+    for (size_t i = 0; i < len; i++) {
+        op->res[i] = -op->a[i];
+    }
+}
+
+static void m_plan_kernel_negate_strided(const m_plan_op_t *op)
+{
+    for (size_t m = 0; m < op->rows; m++) {
+        for (size_t n = 0; n < op->cols; n++) {
+            op->res[m*op->res_rs+n*op->res_cs] = -op->a[m*op->a_rs+n*op->a_cs];
+        }
+    }
+}
+
+static void m_plan_kernel_copy(const m_plan_op_t *op)
+{
+    memcpy(op->res, op->a, op->rows*op->cols*sizeof *op->res);
+}
+
+/* Also does transposes, by recording them with the result's strides swapped. */
+static void m_plan_kernel_copy_strided(const m_plan_op_t *op)
+{
+    for (size_t m = 0; m < op->rows; m++) {
+        for (size_t n = 0; n < op->cols; n++) {
+            op->res[m*op->res_rs+n*op->res_cs] = op->a[m*op->a_rs+n*op->a_cs];
+        }
+    }
+}
+
+/****
+ * Plan management and recording.
+ ****/
+
+m_plan_t* m_plan_new(size_t workspace_len)
+{
+    m_plan_t *plan = NULL;
+
+    plan = calloc(1, sizeof *plan);
+    if (!plan) goto fail;
+
+    if (workspace_len) {
+        plan->workspace = malloc(workspace_len*sizeof *plan->workspace);
+        if (!plan->workspace) goto fail_workspace;
+    }
+    plan->workspace_len = workspace_len;
+    goto out;
+
+    fail_workspace:
+    free(plan);
+
+    fail:
+    plan = NULL;
+
+    out:
+    return plan;
+}
+
+error_t m_plan_del(m_plan_t *plan)
+{
+    if (!plan) return E_OK;
+
+    /* Scratch headers point into the workspace, so only free the headers. */
+    for (size_t i = 0; i < plan->n_scratch; i++) {
+        free(plan->scratch[i]);
+    }
+    free(plan->scratch);
+    free(plan->workspace);
+    free(plan->ops);
+    free(plan);
+
+    return E_OK;
+}
+
+m_t* m_plan_scratch(m_plan_t *plan, size_t rows, size_t cols)
+{
+    m_t *nm = NULL;
+    m_t **scratch = NULL;
+
+    if (!plan) return NULL;
+    if (!rows || !cols) return NULL;
+    if (rows*cols > plan->workspace_len - plan->workspace_used) return NULL;
+
+    scratch = realloc(plan->scratch, (plan->n_scratch+1)*sizeof *scratch);
+    if (!scratch) return NULL;
+    plan->scratch = scratch;
+
+    nm = malloc(sizeof *nm);
+    if (!nm) return NULL;
+
+    nm->rows = rows;
+    nm->cols = cols;
+    nm->order = M_ROW_MAJOR;
+    nm->data = plan->workspace + plan->workspace_used;
+
+    plan->workspace_used += rows*cols;
+    plan->scratch[plan->n_scratch++] = nm;
+
+    return nm;
+}
+
+/* Appends an op.  Operands that aren't used can be NULL. */
+static error_t m_plan_push(m_plan_t *plan, m_plan_kernel kernel,
+                           m_t *a, m_t *b, m_t *res,
+                           size_t rows, size_t cols, size_t inner)
+{
+    if (plan->n_ops == plan->ops_cap) {
+        size_t cap = plan->ops_cap ? 2*plan->ops_cap : 8;
+        m_plan_op_t *ops = realloc(plan->ops, cap*sizeof *ops);
+        if (!ops) return E_ERR;
+        plan->ops = ops;
+        plan->ops_cap = cap;
+    }
+
+    plan->ops[plan->n_ops++] = (m_plan_op_t){
+        .kernel = kernel,
+        .a = a ? a->data : NULL,
+        .b = b ? b->data : NULL,
+        .res = res->data,
+        .rows = rows,
+        .cols = cols,
+        .inner = inner,
+        .a_rs = a ? m_row_stride(a) : 0,
+        .a_cs = a ? m_col_stride(a) : 0,
+        .b_rs = b ? m_row_stride(b) : 0,
+        .b_cs = b ? m_col_stride(b) : 0,
+        .res_rs = m_row_stride(res),
+        .res_cs = m_col_stride(res),
+    };
+
+    return E_OK;
+}
+
+error_t m_plan_mult(m_plan_t *plan, m_t *lhs, m_t *rhs, m_t *res)
+{
+    m_plan_kernel kernel = m_plan_kernel_mult;
+
+    if (!plan || !lhs || !rhs || !res) return E_NULLP;
+    if (lhs->cols != rhs->rows) return E_VAL;
+    if (lhs->rows != res->rows) return E_VAL;
+    if (rhs->cols != res->cols) return E_VAL;
+    if (res->data == lhs->data || res->data == rhs->data) return E_VAL;
+
+    const bool row_major = lhs->order == M_ROW_MAJOR && rhs->order == M_ROW_MAJOR && res->order == M_ROW_MAJOR;
+
+    if (row_major && m_is_square(lhs) && m_is_square(rhs)) {
+        switch (lhs->rows) {
+        case 2: kernel = m_plan_kernel_mult_2; break;
+        case 3: kernel = m_plan_kernel_mult_3; break;
+        case 4: kernel = m_plan_kernel_mult_4; break;
+        default: break;
+        }
+    } else if (rhs->cols == 1) {
+        kernel = m_plan_kernel_mult_vector;
+    }
+
+    return m_plan_push(plan, kernel, lhs, rhs, res, res->rows, res->cols, lhs->cols);
+}
+
+error_t m_plan_mult_vector(m_plan_t *plan, m_t *mat, v_t *vec, v_t *res)
+{
+    m_t vec_m, res_m;
+
+    if (!plan || !mat || !vec || !res) return E_NULLP;
+    if (mat->cols != vec->len) return E_VAL;
+    if (mat->rows != res->len) return E_VAL;
+    if (res->data == vec->data) return E_VAL;
+
+    /* Vectors are recorded as single column matricies. */
+    if (E_OK != m_init_view(&vec_m, vec->len, 1, M_COL_MAJOR, vec->data)) return E_VAL;
+    if (E_OK != m_init_view(&res_m, res->len, 1, M_COL_MAJOR, res->data)) return E_VAL;
+
+    return m_plan_push(plan, m_plan_kernel_mult_vector, mat, &vec_m, &res_m, mat->rows, 1, mat->cols);
+}
+
+error_t m_plan_add(m_plan_t *plan, m_t *lhs, m_t *rhs, m_t *res)
+{
+    if (!plan || !lhs || !rhs || !res) return E_NULLP;
+    if (!m_same_size(lhs, rhs)) return E_VAL;
+    if (!m_same_size(lhs, res)) return E_VAL;
+
+    const bool same_order = lhs->order == res->order && rhs->order == res->order;
+
+    /* Elementwise in place is fine, but not through a different layout. */
+    if (res->data == lhs->data && lhs->order != res->order) return E_VAL;
+    if (res->data == rhs->data && rhs->order != res->order) return E_VAL;
+
+    return m_plan_push(plan, same_order ? m_plan_kernel_add : m_plan_kernel_add_strided,
+                       lhs, rhs, res, res->rows, res->cols, 0);
+}
+
+error_t m_plan_negate(m_plan_t *plan, m_t *mat, m_t *res)
+{
+    if (!plan || !mat || !res) return E_NULLP;
+    if (!m_same_size(mat, res)) return E_VAL;
+    if (res->data == mat->data && mat->order != res->order) return E_VAL;
+
+    return m_plan_push(plan, mat->order == res->order ? m_plan_kernel_negate : m_plan_kernel_negate_strided,
+                       mat, NULL, res, res->rows, res->cols, 0);
+}
+
+error_t m_plan_transpose(m_plan_t *plan, m_t *mat, m_t *res)
+{
+    m_t res_t;
+
+    if (!plan || !mat || !res) return E_NULLP;
+    if (mat->rows != res->cols) return E_VAL;
+    if (mat->cols != res->rows) return E_VAL;
+    if (mat->data == res->data) return E_VAL;
+
+    /* Writing mat into res's storage read in the other order is the transpose.
+       If that other order is mat's own, it's a plain copy.
+    */
+    if (E_OK != m_init_view(&res_t, mat->rows, mat->cols,
+                            res->order == M_ROW_MAJOR ? M_COL_MAJOR : M_ROW_MAJOR, res->data)) {
+        return E_VAL;
+    }
+
+    return m_plan_push(plan, mat->order == res_t.order ? m_plan_kernel_copy : m_plan_kernel_copy_strided,
+                       mat, NULL, &res_t, mat->rows, mat->cols, 0);
+}
+
+error_t m_plan_copy(m_plan_t *plan, m_t *src, m_t *dest)
+{
+    if (!plan || !src || !dest) return E_NULLP;
+    if (!m_same_size(src, dest)) return E_VAL;
+
+    /* Copying onto itself is a no-op, don't bother recording it. */
+    if (src->data == dest->data && src->order == dest->order) return E_OK;
+    if (src->data == dest->data) return E_VAL;
+
+    return m_plan_push(plan, src->order == dest->order ? m_plan_kernel_copy : m_plan_kernel_copy_strided,
+                       src, NULL, dest, dest->rows, dest->cols, 0);
+}
+
+size_t m_plan_len(const m_plan_t *plan)
+{
+    if (!plan) return 0;
+    return plan->n_ops;
+}
+
+error_t m_plan_run(const m_plan_t *plan)
+{
+    if (!plan) return E_NULLP;
+
+    for (size_t i = 0; i < plan->n_ops; i++) {
+        plan->ops[i].kernel(&plan->ops[i]);
+    }
+
+    return E_OK;
+}
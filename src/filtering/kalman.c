@@ -0,0 +1,42 @@
+#include <stdlib.h>
+
+#include "filtering/kalman.h"
+
+error_t kalman_predict(lti_discrete_t *disc, v_t *x, v_t *u, m_t *P)
+{
+    if (!disc || !x || !P) return E_NULLP;
+
+    const size_t n = disc->Phi->rows;
+    if (!disc->Qd) return E_VAL;
+    if (x->len != n || P->rows != n || P->cols != n) return E_VAL;
+
+    error_t err = E_OK;
+    v_data_t next_data[n];
+    v_t next = { .len = n, .data = next_data };
+    err = lti_step(disc, x, u, &next);
+    if (err != E_OK) return err;
+
+    /* work = Phi P, then P = work Phi^T + Qd, which no longer needs P. */
+    m_t *Phi = disc->Phi, *work = disc->_work;
+    err = m_mult(Phi, P, work);
+    if (err != E_OK) return err;
+
+    const size_t prs = m_row_stride(Phi), pcs = m_col_stride(Phi);
+    const size_t wrs = m_row_stride(work), wcs = m_col_stride(work);
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++) {
+            m_data_t s = 0.0;
+            for (size_t j = 0; j < n; j++)
+                s += work->data[m*wrs + j*wcs]*Phi->data[k*prs + j*pcs];
+            m_set(P, m, k, s + m_get(disc->Qd, m, k));
+        }
+    }
+
+    /* x goes last, once nothing else can fail, so a failed predict leaves
+       x and P as they were.
+    */
+    for (size_t i = 0; i < n; i++)
+        x->data[i] = next_data[i];
+
+    return E_OK;
+}
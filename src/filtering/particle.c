@@ -0,0 +1,396 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "filtering/particle.h"
+
+/****
+ * Random numbers.
+ ****/
+
+static uint64_t particle_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t particle_splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Seeds stream number stream of seed. */
+static void particle_rng_seed(particle_rng_t *rng, uint64_t seed, uint64_t stream)
+{
+    uint64_t x = seed ^ particle_splitmix64(&stream);
+    for (size_t k = 0; k < 4; k++)
+        rng->s[k] = particle_splitmix64(&x);
+}
+
+double particle_rng_uniform(particle_rng_t *rng)
+{
+    uint64_t *s = rng->s;
+    const uint64_t result = s[0] + s[3];
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = particle_rotl(s[3], 45);
+
+    return (double)(result >> 11)*0x1.0p-53;
+}
+
+double particle_rng_normal(particle_rng_t *rng)
+{
+    /* Box-Muller.  1 - u keeps the log away from 0. */
+    const double u1 = 1.0 - particle_rng_uniform(rng);
+    const double u2 = particle_rng_uniform(rng);
+    return sqrt(-2.0*log(u1))*cos(2.0*M_PI*u2);
+}
+
+/****
+ * Likelihood kernels.
+ ****/
+
+error_t particle_loglik_gaussian(void *ctx, const v_data_t *states, size_t stride,
+                                 size_t begin, size_t end, v_t *meas, v_data_t *log_lik)
+{
+    const particle_gaussian_t *g = ctx;
+
+    if (!g || !states || !meas || !log_lik) return E_NULLP;
+    if (meas->len != g->n_meas) return E_VAL;
+
+    v_data_t norm = 0.0;
+    for (size_t j = 0; j < g->n_meas; j++)
+        norm -= log(g->sigma[j]) + 0.5*log(2.0*M_PI);
+    for (size_t i = begin; i < end; i++)
+        log_lik[i] = norm;
+
+    /* One measurement at a time so the inner loop runs down a contiguous
+       component of the block.
+    */
+    for (size_t j = 0; j < g->n_meas; j++) {
+        const v_data_t *x = states + g->dims[j]*stride;
+        const v_data_t z = meas->data[j];
+        const v_data_t inv = 1.0/g->sigma[j];
+        for (size_t i = begin; i < end; i++) {
+            const v_data_t r = (x[i] - z)*inv;
+            log_lik[i] -= 0.5*r*r;
+        }
+    }
+
+    return E_OK;
+}
+
+/****
+ * Chunk tasks.  Chunk c covers particles [c*PARTICLE_CHUNK, end) and
+ * reports any failure in _chunk_err[c].
+ ****/
+
+static size_t particle_chunk_end(const particle_filter_t *pf, size_t c)
+{
+    const size_t end = (c+1)*PARTICLE_CHUNK;
+    return end < pf->n_particles ? end : pf->n_particles;
+}
+
+static void particle_propagate_task(void *ctx, size_t c, size_t unused)
+{
+    particle_filter_t *pf = ctx;
+    (void)unused;
+
+    pf->_chunk_err[c] = pf->propagate_fn(pf->ctx, pf->states, pf->n_particles,
+                                         c*PARTICLE_CHUNK, particle_chunk_end(pf, c),
+                                         pf->_dt, pf->_ctrl, &pf->_rng[c]);
+}
+
+/* The log likelihoods go in _states_back, which is free between resamples.
+   Nothing touches log_weights until every chunk's kernel has succeeded, so
+   a failed update leaves the filter as it was: this pass only finds the max
+   of log_weights + ll, the sum pass uses it, and the normalize pass is the
+   one that finally writes.
+*/
+static void particle_weigh_task(void *ctx, size_t c, size_t unused)
+{
+    particle_filter_t *pf = ctx;
+    const size_t begin = c*PARTICLE_CHUNK, end = particle_chunk_end(pf, c);
+    const v_data_t *ll = pf->_states_back;
+    v_data_t max = -INFINITY;
+    (void)unused;
+
+    pf->_chunk_err[c] = pf->loglik_fn(pf->ctx, pf->states, pf->n_particles, begin, end, pf->_meas, pf->_states_back);
+    /* ll holds nothing useful if the kernel failed. */
+    if (pf->_chunk_err[c] != E_OK) return;
+
+    for (size_t i = begin; i < end; i++) {
+        const v_data_t lw = pf->log_weights[i] + ll[i];
+        max = lw > max ? lw : max;
+    }
+    pf->_chunk_val[c] = max;
+}
+
+static void particle_sum_task(void *ctx, size_t c, size_t unused)
+{
+    particle_filter_t *pf = ctx;
+    const v_data_t *ll = pf->_states_back;
+    v_data_t sum = 0.0;
+    (void)unused;
+
+    for (size_t i = c*PARTICLE_CHUNK; i < particle_chunk_end(pf, c); i++)
+        sum += exp(pf->log_weights[i] + ll[i] - pf->_shift);
+    pf->_chunk_val[c] = sum;
+}
+
+static void particle_normalize_task(void *ctx, size_t c, size_t unused)
+{
+    particle_filter_t *pf = ctx;
+    const v_data_t *ll = pf->_states_back;
+    (void)unused;
+
+    for (size_t i = c*PARTICLE_CHUNK; i < particle_chunk_end(pf, c); i++)
+        pf->log_weights[i] += ll[i] - pf->_shift;
+}
+
+static void particle_gather_task(void *ctx, size_t c, size_t unused)
+{
+    particle_filter_t *pf = ctx;
+    const size_t n = pf->n_particles, begin = c*PARTICLE_CHUNK, end = particle_chunk_end(pf, c);
+    const v_data_t uniform = -log((v_data_t)n);
+    (void)unused;
+
+    for (size_t d = 0; d < pf->st_len; d++) {
+        const v_data_t *src = pf->states + d*n;
+        v_data_t *dst = pf->_states_back + d*n;
+        for (size_t j = begin; j < end; j++)
+            dst[j] = src[pf->_idx[j]];
+    }
+    for (size_t j = begin; j < end; j++)
+        pf->log_weights[j] = uniform;
+}
+
+/* Builds a graph of independent tasks running fn once per chunk. */
+static parallel_graph_t* particle_chunk_graph(particle_filter_t *pf, parallel_task_fn fn)
+{
+    parallel_graph_t *g = parallel_graph_new(pf);
+    if (!g) return NULL;
+
+    for (size_t c = 0; c < pf->_n_chunks; c++) {
+        if (E_OK != parallel_graph_add(g, fn, c, 0, NULL)) {
+            parallel_graph_del(g);
+            return NULL;
+        }
+    }
+
+    return g;
+}
+
+static error_t particle_run(particle_filter_t *pf, parallel_graph_t *g)
+{
+    for (size_t c = 0; c < pf->_n_chunks; c++)
+        pf->_chunk_err[c] = E_OK;
+
+    if (E_OK != parallel_graph_run(g)) return E_ERR;
+
+    for (size_t c = 0; c < pf->_n_chunks; c++) {
+        if (pf->_chunk_err[c] != E_OK) return pf->_chunk_err[c];
+    }
+    return E_OK;
+}
+
+/****
+ * The filter.
+ ****/
+
+particle_filter_t* particle_filter_new(size_t n_particles, size_t st_len,
+                                       particle_propagate_fn propagate_fn,
+                                       particle_loglik_fn loglik_fn,
+                                       void *ctx,
+                                       uint64_t seed)
+{
+    particle_filter_t *pf = NULL;
+
+    if (!n_particles || !st_len || !propagate_fn || !loglik_fn) return NULL;
+
+    pf = calloc(1, sizeof *pf);
+    if (!pf) return NULL;
+
+    pf->n_particles = n_particles;
+    pf->st_len = st_len;
+    pf->propagate_fn = propagate_fn;
+    pf->loglik_fn = loglik_fn;
+    pf->ctx = ctx;
+    pf->_n_chunks = (n_particles + PARTICLE_CHUNK - 1)/PARTICLE_CHUNK;
+
+    pf->states = malloc(st_len*n_particles*sizeof *pf->states);
+    pf->_states_back = malloc(st_len*n_particles*sizeof *pf->_states_back);
+    pf->log_weights = malloc(n_particles*sizeof *pf->log_weights);
+    pf->_idx = malloc(n_particles*sizeof *pf->_idx);
+    pf->_rng = malloc(pf->_n_chunks*sizeof *pf->_rng);
+    pf->_chunk_err = malloc(pf->_n_chunks*sizeof *pf->_chunk_err);
+    pf->_chunk_val = malloc(pf->_n_chunks*sizeof *pf->_chunk_val);
+    if (!pf->states || !pf->_states_back || !pf->log_weights || !pf->_idx ||
+        !pf->_rng || !pf->_chunk_err || !pf->_chunk_val) {
+        goto fail;
+    }
+
+    pf->_propagate = particle_chunk_graph(pf, particle_propagate_task);
+    pf->_weigh = particle_chunk_graph(pf, particle_weigh_task);
+    pf->_sum = particle_chunk_graph(pf, particle_sum_task);
+    pf->_normalize = particle_chunk_graph(pf, particle_normalize_task);
+    pf->_gather = particle_chunk_graph(pf, particle_gather_task);
+    if (!pf->_propagate || !pf->_weigh || !pf->_sum || !pf->_normalize || !pf->_gather) {
+        goto fail;
+    }
+
+    for (size_t c = 0; c < pf->_n_chunks; c++)
+        particle_rng_seed(&pf->_rng[c], seed, c);
+    particle_rng_seed(&pf->_rng_resample, seed, pf->_n_chunks);
+
+    for (size_t i = 0; i < n_particles; i++)
+        pf->log_weights[i] = -log((v_data_t)n_particles);
+
+    return pf;
+
+    fail:
+    particle_filter_del(pf);
+    return NULL;
+}
+
+error_t particle_filter_del(particle_filter_t *pf)
+{
+    if (!pf) return E_OK;
+
+    parallel_graph_del(pf->_propagate);
+    parallel_graph_del(pf->_weigh);
+    parallel_graph_del(pf->_sum);
+    parallel_graph_del(pf->_normalize);
+    parallel_graph_del(pf->_gather);
+    free(pf->states);
+    free(pf->_states_back);
+    free(pf->log_weights);
+    free(pf->_idx);
+    free(pf->_rng);
+    free(pf->_chunk_err);
+    free(pf->_chunk_val);
+    free(pf);
+
+    return E_OK;
+}
+
+error_t particle_filter_init_gaussian(particle_filter_t *pf, v_t *mean, v_t *std)
+{
+    if (!pf || !mean || !std) return E_NULLP;
+    if (mean->len != pf->st_len || std->len != pf->st_len) return E_VAL;
+
+    const size_t n = pf->n_particles;
+    for (size_t c = 0; c < pf->_n_chunks; c++) {
+        for (size_t d = 0; d < pf->st_len; d++) {
+            for (size_t i = c*PARTICLE_CHUNK; i < particle_chunk_end(pf, c); i++)
+                pf->states[d*n + i] = mean->data[d] + std->data[d]*particle_rng_normal(&pf->_rng[c]);
+        }
+    }
+
+    for (size_t i = 0; i < n; i++)
+        pf->log_weights[i] = -log((v_data_t)n);
+
+    return E_OK;
+}
+
+error_t particle_filter_predict(particle_filter_t *pf, float dt, v_t *cur_ctrl)
+{
+    if (!pf) return E_NULLP;
+
+    pf->_dt = dt;
+    pf->_ctrl = cur_ctrl;
+    return particle_run(pf, pf->_propagate);
+}
+
+error_t particle_filter_update(particle_filter_t *pf, v_t *meas)
+{
+    error_t err;
+
+    if (!pf || !meas) return E_NULLP;
+
+    pf->_meas = meas;
+    err = particle_run(pf, pf->_weigh);
+    if (err != E_OK) return err;
+
+    /* log-sum-exp: shift by the max so the biggest term is exp(0). */
+    v_data_t max = -INFINITY;
+    for (size_t c = 0; c < pf->_n_chunks; c++)
+        max = pf->_chunk_val[c] > max ? pf->_chunk_val[c] : max;
+    if (!isfinite(max)) return E_ERR;
+
+    pf->_shift = max;
+    err = particle_run(pf, pf->_sum);
+    if (err != E_OK) return err;
+
+    v_data_t sum = 0.0;
+    for (size_t c = 0; c < pf->_n_chunks; c++)
+        sum += pf->_chunk_val[c];
+
+    pf->_shift = max + log(sum);
+    return particle_run(pf, pf->_normalize);
+}
+
+v_data_t particle_filter_ess(particle_filter_t *pf)
+{
+    if (!pf) return V_NAN;
+
+    v_data_t sum = 0.0;
+    for (size_t i = 0; i < pf->n_particles; i++)
+        sum += exp(2.0*pf->log_weights[i]);
+
+    return 1.0/sum;
+}
+
+error_t particle_filter_resample(particle_filter_t *pf, particle_resample_t method)
+{
+    if (!pf) return E_NULLP;
+    if (method != PARTICLE_SYSTEMATIC && method != PARTICLE_STRATIFIED) return E_VAL;
+
+    /* Walk the slots (j + u_j)/n and the cumulative weights together. */
+    const size_t n = pf->n_particles;
+    const double offset = particle_rng_uniform(&pf->_rng_resample);
+    double cum = exp(pf->log_weights[0]);
+    size_t i = 0;
+
+    for (size_t j = 0; j < n; j++) {
+        const double u = method == PARTICLE_SYSTEMATIC ? offset : particle_rng_uniform(&pf->_rng_resample);
+        const double slot = (j + u)/(double)n;
+        while (slot > cum && i + 1 < n) {
+            i++;
+            cum += exp(pf->log_weights[i]);
+        }
+        pf->_idx[j] = i;
+    }
+
+    error_t err = particle_run(pf, pf->_gather);
+    if (err != E_OK) return err;
+
+    v_data_t *tmp = pf->states;
+    pf->states = pf->_states_back;
+    pf->_states_back = tmp;
+
+    return E_OK;
+}
+
+error_t particle_filter_mean(particle_filter_t *pf, v_t *mean)
+{
+    if (!pf || !mean) return E_NULLP;
+    if (mean->len != pf->st_len) return E_VAL;
+
+    const size_t n = pf->n_particles;
+    for (size_t d = 0; d < pf->st_len; d++) {
+        const v_data_t *x = pf->states + d*n;
+        v_data_t s = 0.0;
+        for (size_t i = 0; i < n; i++)
+            s += exp(pf->log_weights[i])*x[i];
+        mean->data[d] = s;
+    }
+
+    return E_OK;
+}
@@ -0,0 +1,290 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "integrators/adjoint.h"
+
+integrator_adjoint_t* integrator_adjoint_new(state_fn fn, state_vjp_fn vjp_fn,
+                                             size_t st_len, size_t ctrl_len, size_t n_checkpoints)
+{
+    integrator_adjoint_t *adj = NULL;
+
+    if (!fn || !vjp_fn || !st_len) return NULL;
+
+    adj = calloc(1, sizeof *adj);
+    if (!adj) return NULL;
+
+    adj->fn = fn;
+    adj->vjp_fn = vjp_fn;
+    adj->n_checkpoints = n_checkpoints;
+
+    adj->_checkpoints = malloc((n_checkpoints ? n_checkpoints : 1)*st_len*sizeof *adj->_checkpoints);
+    adj->_w0 = v_new(st_len);
+    adj->_w1 = v_new(st_len);
+    for (size_t i=0; i < 3; i++)
+        adj->_k[i] = v_new(st_len);
+    adj->_y = v_new(st_len);
+    adj->_kbar = v_new(st_len);
+    adj->_ybar = v_new(st_len);
+    adj->_xbar = v_new(st_len);
+    if (ctrl_len) adj->_ubar = v_new(ctrl_len);
+
+    if (!adj->_checkpoints || !adj->_w0 || !adj->_w1 || !adj->_k[0] || !adj->_k[1] || !adj->_k[2] ||
+        !adj->_y || !adj->_kbar || !adj->_ybar || !adj->_xbar || (ctrl_len && !adj->_ubar)) {
+        integrator_adjoint_del(adj);
+        return NULL;
+    }
+
+    return adj;
+}
+
+error_t integrator_adjoint_del(integrator_adjoint_t *adj)
+{
+    if (!adj) return E_OK;
+
+    free(adj->_checkpoints);
+    v_del(adj->_w0);
+    v_del(adj->_w1);
+    for (size_t i=0; i < 3; i++)
+        v_del(adj->_k[i]);
+    v_del(adj->_y);
+    v_del(adj->_kbar);
+    v_del(adj->_ybar);
+    v_del(adj->_xbar);
+    v_del(adj->_ubar);
+    free(adj);
+
+    return E_OK;
+}
+
+/* Everything about one integrator_adjoint_rk4 call. */
+typedef struct adjoint_run {
+    integrator_adjoint_t *adj;
+    terminal_grad_fn grad_fn;
+    float dt;
+    v_t *ctrl;
+    v_t *final_st;
+    /* The adjoint of the current state and the control gradient so far. */
+    v_t *lambda;
+    v_t *mu;
+    /* Set once the last step has been reached and lambda holds something. */
+    bool started;
+} adjoint_run_t;
+
+/* Takes l steps from x and returns the work vector holding the result. */
+static v_t* adjoint_advance(adjoint_run_t *run, const v_data_t *x, size_t l)
+{
+    integrator_adjoint_t *adj = run->adj;
+    v_t *cur = adj->_w0, *next = adj->_w1;
+
+    memcpy(cur->data, x, cur->len*sizeof *x);
+    for (size_t i=0; i < l; i++) {
+        if (E_OK != integrator_rk4(adj->fn, run->dt, cur, run->ctrl, next)) return NULL;
+        v_t *tmp = cur;
+        cur = next;
+        next = tmp;
+    }
+    adj->n_forward_steps += l;
+
+    return cur;
+}
+
+/* Unsafe - does no checks.
+
+   y = x + a*k
+*/
+static void adjoint_axpy(v_t *y, const v_t *x, double a, const v_t *k)
+{
+    for (size_t i=0; i < y->len; i++)
+        y->data[i] = x->data[i] + a*k->data[i];
+}
+
+/* Calls the vjp at y for kbar and accumulates the results into xbar and mu. */
+static error_t adjoint_stage(adjoint_run_t *run, v_t *y)
+{
+    integrator_adjoint_t *adj = run->adj;
+    v_t *ubar = run->mu ? adj->_ubar : NULL;
+
+    if (E_OK != adj->vjp_fn(y, run->ctrl, adj->_kbar, adj->_ybar, ubar)) return E_ERR;
+
+    for (size_t i=0; i < adj->_xbar->len; i++)
+        adj->_xbar->data[i] += adj->_ybar->data[i];
+    if (ubar) {
+        for (size_t i=0; i < ubar->len; i++)
+            run->mu->data[i] += ubar->data[i];
+    }
+
+    return E_OK;
+}
+
+/* Takes lambda from the end of the step starting at x back to its start.
+
+   The stages of the step are recomputed, then the RK4 map is differentiated
+   in reverse.  With y_i the stage inputs and k_i = f(y_i):
+       kbar_4 = h/6 lambda
+       kbar_3 = h/3 lambda + h   ybar_4
+       kbar_2 = h/3 lambda + h/2 ybar_3
+       kbar_1 = h/6 lambda + h/2 ybar_2
+   where ybar_i = J(y_i)^T kbar_i, and the new lambda is lambda + sum ybar_i.
+
+   If this is the very last step the end state is formed here too, and the
+   terminal gradient starts lambda off.
+*/
+static error_t adjoint_step(adjoint_run_t *run, v_t *x)
+{
+    integrator_adjoint_t *adj = run->adj;
+    const double h = run->dt;
+    v_t **k = adj->_k, *y = adj->_y, *kbar = adj->_kbar;
+    v_t *ybar = adj->_ybar, *xbar = adj->_xbar, *lambda = run->lambda;
+    const size_t n = x->len;
+
+    if (E_OK != adj->fn(x, run->ctrl, k[0])) return E_ERR;
+    adjoint_axpy(y, x, h/2.0, k[0]);
+    if (E_OK != adj->fn(y, run->ctrl, k[1])) return E_ERR;
+    adjoint_axpy(y, x, h/2.0, k[1]);
+    if (E_OK != adj->fn(y, run->ctrl, k[2])) return E_ERR;
+
+    if (!run->started) {
+        /* xbar and kbar are free until the reverse pass below. */
+        adjoint_axpy(y, x, h, k[2]);
+        if (E_OK != adj->fn(y, run->ctrl, kbar)) return E_ERR;
+        for (size_t i=0; i < n; i++) {
+            xbar->data[i] = x->data[i] + h/6.0*(k[0]->data[i] + 2*k[1]->data[i]
+                                                + 2*k[2]->data[i] + kbar->data[i]);
+        }
+        adj->n_forward_steps++;
+
+        if (run->final_st) memcpy(run->final_st->data, xbar->data, n*sizeof *xbar->data);
+        if (E_OK != run->grad_fn(xbar, lambda)) return E_ERR;
+        run->started = true;
+    }
+
+    memcpy(xbar->data, lambda->data, n*sizeof *lambda->data);
+
+    for (size_t i=0; i < n; i++)
+        kbar->data[i] = h/6.0*lambda->data[i];
+    adjoint_axpy(y, x, h, k[2]);
+    if (E_OK != adjoint_stage(run, y)) return E_ERR;
+
+    for (size_t i=0; i < n; i++)
+        kbar->data[i] = h/3.0*lambda->data[i] + h*ybar->data[i];
+    adjoint_axpy(y, x, h/2.0, k[1]);
+    if (E_OK != adjoint_stage(run, y)) return E_ERR;
+
+    for (size_t i=0; i < n; i++)
+        kbar->data[i] = h/3.0*lambda->data[i] + h/2.0*ybar->data[i];
+    adjoint_axpy(y, x, h/2.0, k[0]);
+    if (E_OK != adjoint_stage(run, y)) return E_ERR;
+
+    for (size_t i=0; i < n; i++)
+        kbar->data[i] = h/6.0*lambda->data[i] + h/2.0*ybar->data[i];
+    if (E_OK != adjoint_stage(run, x)) return E_ERR;
+
+    memcpy(lambda->data, xbar->data, n*sizeof *xbar->data);
+    return E_OK;
+}
+
+/* (s+t choose s), the most steps s checkpoints can reverse if each step may
+   be computed at most t times (Griewank's beta).
+*/
+static double adjoint_beta(size_t s, size_t t)
+{
+    double b = 1.0;
+    for (size_t i=1; i <= s; i++)
+        b = b*(double)(t + i)/(double)i;
+    return b;
+}
+
+/* Where to put the next checkpoint when reversing l > 1 steps from x with
+   s > 0 checkpoints free.  x itself is held too, so in revolve's terms there
+   are s+1 checkpoints.  With t the fewest repetitions that can handle l
+   steps, the part right of the new checkpoint gets as many steps as s can
+   handle in t repetitions, which leaves few enough for the left part to be
+   done with s+1 in t-1.
+*/
+static size_t adjoint_split(size_t l, size_t s)
+{
+    size_t t = 1;
+    while (adjoint_beta(s+1, t) < (double)l)
+        t++;
+
+    const double right = adjoint_beta(s, t);
+    return right >= (double)(l - 1) ? 1 : l - (size_t)right;
+}
+
+/* Reverses the l steps starting at x with s checkpoints still free.  Going
+   right first means the very first call runs forward to the end, leaving
+   checkpoints along the way.
+*/
+static error_t adjoint_reverse(adjoint_run_t *run, v_t *x, size_t l, size_t s)
+{
+    integrator_adjoint_t *adj = run->adj;
+
+    if (l == 0) return E_OK;
+    if (l == 1) return adjoint_step(run, x);
+
+    if (s == 0) {
+        /* Out of memory: recompute every step from x. */
+        for (size_t j=l; j-- > 0;) {
+            v_t *xj = adjoint_advance(run, x->data, j);
+            if (!xj) return E_ERR;
+            if (E_OK != adjoint_step(run, xj)) return E_ERR;
+        }
+        return E_OK;
+    }
+
+    const size_t lh = adjoint_split(l, s);
+    v_t ckpt = { .len = x->len,
+                 .data = adj->_checkpoints + (adj->n_checkpoints - s)*x->len };
+
+    v_t *xl = adjoint_advance(run, x->data, lh);
+    if (!xl) return E_ERR;
+    memcpy(ckpt.data, xl->data, x->len*sizeof *xl->data);
+
+    if (E_OK != adjoint_reverse(run, &ckpt, l - lh, s - 1)) return E_ERR;
+    return adjoint_reverse(run, x, lh, s);
+}
+
+error_t integrator_adjoint_rk4(integrator_adjoint_t *adj,
+                               terminal_grad_fn grad_fn,
+                               float dt,
+                               size_t n_steps,
+                               v_t *init_st,
+                               v_t *cur_ctrl,
+                               v_t *final_st,
+                               v_t *st_grad,
+                               v_t *ctrl_grad)
+{
+    if (!adj || !grad_fn || !init_st || !st_grad) return E_NULLP;
+
+    const size_t n = adj->_w0->len;
+    if (init_st->len != n || st_grad->len != n || (final_st && final_st->len != n)) return E_VAL;
+    if (init_st->data == st_grad->data) return E_VAL;
+
+    /* The control and its gradient come together, or not at all. */
+    if (!adj->_ubar != !cur_ctrl || !cur_ctrl != !ctrl_grad) return E_VAL;
+    if (cur_ctrl && (cur_ctrl->len != adj->_ubar->len || ctrl_grad->len != adj->_ubar->len)) return E_VAL;
+
+    adjoint_run_t run = {
+        .adj = adj,
+        .grad_fn = grad_fn,
+        .dt = dt,
+        .ctrl = cur_ctrl,
+        .final_st = final_st,
+        .lambda = st_grad,
+        .mu = ctrl_grad,
+    };
+
+    adj->n_forward_steps = 0;
+    if (ctrl_grad) {
+        for (size_t i=0; i < ctrl_grad->len; i++)
+            ctrl_grad->data[i] = 0.0;
+    }
+
+    if (n_steps == 0) {
+        if (final_st) memcpy(final_st->data, init_st->data, n*sizeof *init_st->data);
+        return grad_fn(init_st, st_grad);
+    }
+
+    return adjoint_reverse(&run, init_st, n_steps, adj->n_checkpoints);
+}
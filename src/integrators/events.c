@@ -0,0 +1,194 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "integrators/events.h"
+
+/* Hard stop for the root finder in case tol is unreachable. */
+#define EVENTS_MAX_ITER 100
+
+integrator_events_t* integrator_events_new(integrator_event_t *events, size_t n_events, size_t st_len)
+{
+    integrator_events_t *ev = NULL;
+
+    if (!events || !n_events || !st_len) return NULL;
+
+    ev = calloc(1, sizeof *ev);
+    if (!ev) return NULL;
+
+    ev->events = events;
+    ev->n_events = n_events;
+    ev->tol = 1e-9;
+
+    ev->_f0 = v_new(st_len);
+    ev->_f1 = v_new(st_len);
+    ev->_interp = v_new(st_len);
+    ev->_g0 = malloc(n_events*sizeof *ev->_g0);
+    ev->_g1 = malloc(n_events*sizeof *ev->_g1);
+
+    if (!ev->_f0 || !ev->_f1 || !ev->_interp || !ev->_g0 || !ev->_g1) {
+        integrator_events_del(ev);
+        return NULL;
+    }
+
+    return ev;
+}
+
+error_t integrator_events_del(integrator_events_t *ev)
+{
+    if (!ev) return E_OK;
+
+    v_del(ev->_f0);
+    v_del(ev->_f1);
+    v_del(ev->_interp);
+    free(ev->_g0);
+    free(ev->_g1);
+    free(ev);
+
+    return E_OK;
+}
+
+/* Unsafe - does no checks.
+
+   Evaluates the cubic Hermite interpolant of the step at fraction theta
+   into ev->_interp.
+*/
+static void events_interpolate(integrator_events_t *ev, float dt, v_t *y0, v_t *y1, double theta)
+{
+    const double t2 = theta*theta, t3 = t2*theta;
+    const double h00 = 2*t3 - 3*t2 + 1;
+    const double h10 = t3 - 2*t2 + theta;
+    const double h01 = -2*t3 + 3*t2;
+    const double h11 = t3 - t2;
+
+    for (size_t i=0; i < y0->len; i++) {
+        ev->_interp->data[i] = h00*y0->data[i] + h10*dt*ev->_f0->data[i]
+                             + h01*y1->data[i] + h11*dt*ev->_f1->data[i];
+    }
+}
+
+static bool events_crossed(integrator_event_dir_t dir, v_data_t g0, v_data_t g1)
+{
+    bool rising = g0 < 0 && g1 >= 0;
+    bool falling = g0 > 0 && g1 <= 0;
+
+    switch (dir) {
+    case EVENT_RISING: return rising;
+    case EVENT_FALLING: return falling;
+    default: return rising || falling;
+    }
+}
+
+/* Finds the crossing of event idx on the interpolant.  *theta_hi is the end
+   of the final bracket on the far side of the crossing.
+*/
+static error_t events_localize(integrator_events_t *ev, size_t idx, float dt,
+                               v_t *y0, v_t *cur_ctrl, v_t *y1, double *theta_hi)
+{
+    event_fn g = ev->events[idx].fn;
+    double lo = 0.0, hi = 1.0;
+    v_data_t g_lo = ev->_g0[idx], g_hi = ev->_g1[idx];
+    /* g0 is never 0 for a crossing, so it tells us which sign is past it. */
+    const bool past_pos = g_lo < 0;
+    int side = 0;
+
+    for (int iter=0; iter < EVENTS_MAX_ITER && (hi - lo)*fabs(dt) > ev->tol; iter++) {
+        double mid = (lo*g_hi - hi*g_lo)/(g_hi - g_lo);
+        v_data_t g_mid;
+
+        /* Regula falsi can stall against one end; fall back to bisection if
+           the secant lands outside (or on the edge of) the bracket.
+        */
+        if (!(mid > lo && mid < hi)) mid = 0.5*(lo + hi);
+
+        events_interpolate(ev, dt, y0, y1, mid);
+        if (E_OK != g(ev->_interp, cur_ctrl, &g_mid)) return E_ERR;
+
+        if (g_mid == 0 || (g_mid > 0) == past_pos) {
+            hi = mid;
+            g_hi = g_mid;
+            /* Illinois: halve the stale end's value if it stuck twice. */
+            if (side == 1) g_lo /= 2;
+            side = 1;
+        } else {
+            lo = mid;
+            g_lo = g_mid;
+            if (side == -1) g_hi /= 2;
+            side = -1;
+        }
+    }
+
+    *theta_hi = hi;
+    return E_OK;
+}
+
+error_t integrator_events_step(integrator_events_t *ev,
+                               integrator_fn int_fn,
+                               state_fn fn,
+                               float dt,
+                               v_t *cur_st,
+                               v_t *cur_ctrl,
+                               v_t *next_st,
+                               float *dt_taken,
+                               bool *terminated)
+{
+    bool any_crossed = false;
+    double theta_end = 1.0;
+    size_t terminal_idx = ev ? ev->n_events : 0;
+    double theta[ev ? ev->n_events : 1];
+
+    if (!ev || !int_fn || !fn || !cur_st || !next_st || !dt_taken || !terminated) return E_NULLP;
+    if (cur_st->len != ev->_interp->len || next_st->len != cur_st->len) return E_VAL;
+    if (cur_st->data == next_st->data) return E_VAL;
+
+    *dt_taken = dt;
+    *terminated = false;
+
+    for (size_t i=0; i < ev->n_events; i++) {
+        ev->events[i].fired = false;
+        if (E_OK != ev->events[i].fn(cur_st, cur_ctrl, &ev->_g0[i])) return E_ERR;
+    }
+
+    if (E_OK != int_fn(fn, dt, cur_st, cur_ctrl, next_st)) return E_ERR;
+
+    for (size_t i=0; i < ev->n_events; i++) {
+        if (E_OK != ev->events[i].fn(next_st, cur_ctrl, &ev->_g1[i])) return E_ERR;
+        any_crossed |= events_crossed(ev->events[i].direction, ev->_g0[i], ev->_g1[i]);
+    }
+
+    if (!any_crossed) return E_OK;
+
+    /* Something happened.  Build the interpolant and find out when. */
+    if (E_OK != fn(cur_st, cur_ctrl, ev->_f0)) return E_ERR;
+    if (E_OK != fn(next_st, cur_ctrl, ev->_f1)) return E_ERR;
+
+    for (size_t i=0; i < ev->n_events; i++) {
+        theta[i] = -1.0;
+        if (!events_crossed(ev->events[i].direction, ev->_g0[i], ev->_g1[i])) continue;
+
+        if (E_OK != events_localize(ev, i, dt, cur_st, cur_ctrl, next_st, &theta[i])) return E_ERR;
+
+        if (ev->events[i].terminal && (terminal_idx == ev->n_events || theta[i] < theta_end)) {
+            theta_end = theta[i];
+            terminal_idx = i;
+        }
+    }
+
+    for (size_t i=0; i < ev->n_events; i++) {
+        if (theta[i] < 0 || theta[i] > theta_end) continue;
+        if (ev->events[i].terminal && i != terminal_idx) continue;
+
+        ev->events[i].fired = true;
+        ev->events[i].t = (float)(theta[i]*dt);
+    }
+
+    if (terminal_idx < ev->n_events) {
+        events_interpolate(ev, dt, cur_st, next_st, theta_end);
+        for (size_t i=0; i < next_st->len; i++)
+            next_st->data[i] = ev->_interp->data[i];
+
+        *dt_taken = (float)(theta_end*dt);
+        *terminated = true;
+    }
+
+    return E_OK;
+}
@@ -0,0 +1,74 @@
+#include <stdlib.h>
+
+#include "integrators/integrator.h"
+
+integrator_t* integrator_new(integrator_fn int_fn)
+{
+    integrator_t *ni = NULL;
+    if (!int_fn) return NULL;
+
+    ni = malloc(sizeof *ni);
+    if (!ni) return NULL;
+
+    ni->int_fn = int_fn;
+    return ni;
+}
+
+error_t integrator_del(integrator_t *integrator)
+{
+    if (!integrator) return E_OK;
+    free(integrator);
+    return E_OK;
+}
+
+error_t integrator_euler(state_fn fn, float dt, v_t *cur_st, v_t *cur_ctrl, v_t *next_st)
+{
+    if (!fn || !cur_st || !next_st) return E_NULLP;
+    if (cur_st->len != next_st->len) return E_VAL;
+    if (cur_st->data == next_st->data) return E_VAL;
+
+    /* Use next_st to hold the rate, then step in place. */
+    if (E_OK != fn(cur_st, cur_ctrl, next_st)) return E_ERR;
+
+    for (size_t i=0; i < cur_st->len; i++)
+        next_st->data[i] = cur_st->data[i] + dt*next_st->data[i];
+
+    return E_OK;
+}
+
+error_t integrator_rk4(state_fn fn, float dt, v_t *cur_st, v_t *cur_ctrl, v_t *next_st)
+{
+    if (!fn || !cur_st || !next_st) return E_NULLP;
+    if (cur_st->len != next_st->len) return E_VAL;
+    if (cur_st->data == next_st->data) return E_VAL;
+
+    const size_t n = cur_st->len;
+    v_data_t k_data[n], y_data[n];
+    v_t k = { .len = n, .data = k_data };
+    v_t y = { .len = n, .data = y_data };
+
+    /* next_st accumulates the weighted sum of the stages as they are computed. */
+    if (E_OK != fn(cur_st, cur_ctrl, &k)) return E_ERR;
+    for (size_t i=0; i < n; i++) {
+        next_st->data[i] = cur_st->data[i] + dt/6.0*k.data[i];
+        y.data[i] = cur_st->data[i] + dt/2.0*k.data[i];
+    }
+
+    if (E_OK != fn(&y, cur_ctrl, &k)) return E_ERR;
+    for (size_t i=0; i < n; i++) {
+        next_st->data[i] += dt/3.0*k.data[i];
+        y.data[i] = cur_st->data[i] + dt/2.0*k.data[i];
+    }
+
+    if (E_OK != fn(&y, cur_ctrl, &k)) return E_ERR;
+    for (size_t i=0; i < n; i++) {
+        next_st->data[i] += dt/3.0*k.data[i];
+        y.data[i] = cur_st->data[i] + dt*k.data[i];
+    }
+
+    if (E_OK != fn(&y, cur_ctrl, &k)) return E_ERR;
+    for (size_t i=0; i < n; i++)
+        next_st->data[i] += dt/6.0*k.data[i];
+
+    return E_OK;
+}
@@ -0,0 +1,282 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "integrators/lti.h"
+#include "linear_algebra/exponential.h"
+
+lti_discrete_t* lti_discrete_new(size_t n_states, size_t n_ctrl, bool noise)
+{
+    lti_discrete_t *disc = NULL;
+
+    if (!n_states) return NULL;
+
+    disc = calloc(1, sizeof *disc);
+    if (!disc) return NULL;
+
+    disc->Phi = m_new(n_states, n_states);
+    disc->_work = m_new(n_states, n_states);
+    if (n_ctrl) disc->Gamma = m_new(n_states, n_ctrl);
+    if (noise) disc->Qd = m_new(n_states, n_states);
+
+    if (!disc->Phi || !disc->_work || (n_ctrl && !disc->Gamma) || (noise && !disc->Qd)) {
+        lti_discrete_del(disc);
+        return NULL;
+    }
+
+    return disc;
+}
+
+error_t lti_discrete_del(lti_discrete_t *disc)
+{
+    if (!disc) return E_OK;
+
+    m_del(disc->Phi);
+    m_del(disc->Gamma);
+    m_del(disc->Qd);
+    m_del(disc->_work);
+    free(disc);
+
+    return E_OK;
+}
+
+error_t lti_discretize(m_t *A, m_t *B, m_t *Qc, float dt, lti_discrete_t *disc)
+{
+    m_t *C = NULL;
+    error_t err = E_ERR;
+
+    if (!A || !disc) return E_NULLP;
+
+    const size_t n = disc->Phi->rows;
+    const size_t nc = disc->Gamma ? disc->Gamma->cols : 0;
+    if (A->rows != n || A->cols != n) return E_VAL;
+    if (!B != !disc->Gamma || (B && (B->rows != n || B->cols != nc))) return E_VAL;
+    if (!Qc != !disc->Qd || (Qc && (Qc->rows != n || Qc->cols != n))) return E_VAL;
+
+    disc->dt = dt;
+
+    /* [A B; 0 0] dt, or just A dt without a control. */
+    C = m_new(n + nc, n + nc);
+    if (!C || E_OK != m_set_all(C, 0.0)) goto out;
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++)
+            m_set(C, m, k, dt*m_get(A, m, k));
+        for (size_t k = 0; k < nc; k++)
+            m_set(C, m, n + k, dt*m_get(B, m, k));
+    }
+    if (E_OK != la_expm(C, C)) goto out;
+
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++)
+            m_set(disc->Phi, m, k, m_get(C, m, k));
+        for (size_t k = 0; k < nc; k++)
+            m_set(disc->Gamma, m, k, m_get(C, m, n + k));
+    }
+
+    if (Qc) {
+        m_del(C);
+        C = m_new(2*n, 2*n);
+        if (!C || E_OK != m_set_all(C, 0.0)) goto out;
+
+        for (size_t m = 0; m < n; m++) {
+            for (size_t k = 0; k < n; k++) {
+                m_set(C, m, k, -dt*m_get(A, m, k));
+                m_set(C, m, n + k, dt*m_get(Qc, m, k));
+                m_set(C, n + m, n + k, dt*m_get(A, k, m));
+            }
+        }
+        if (E_OK != la_expm(C, C)) goto out;
+
+        /* Qd = Phi F12, symmetrized to clean up rounding. */
+        for (size_t m = 0; m < n; m++) {
+            for (size_t k = 0; k < n; k++) {
+                m_data_t s = 0.0;
+                for (size_t j = 0; j < n; j++)
+                    s += m_get(disc->Phi, m, j)*m_get(C, j, n + k);
+                m_set(disc->_work, m, k, s);
+            }
+        }
+        for (size_t m = 0; m < n; m++) {
+            for (size_t k = 0; k < n; k++)
+                m_set(disc->Qd, m, k, (m_get(disc->_work, m, k) + m_get(disc->_work, k, m))/2);
+        }
+    }
+    err = E_OK;
+
+    out:
+    m_del(C);
+    return err;
+}
+
+error_t lti_step(lti_discrete_t *disc, v_t *cur_st, v_t *cur_ctrl, v_t *next_st)
+{
+    if (!disc || !cur_st || !next_st) return E_NULLP;
+
+    const m_t *Phi = disc->Phi, *Gamma = disc->Gamma;
+    const size_t n = Phi->rows;
+    if (cur_st->len != n || next_st->len != n) return E_VAL;
+    if (cur_st->data == next_st->data) return E_VAL;
+    if (Gamma && (!cur_ctrl || cur_ctrl->len != Gamma->cols)) return E_VAL;
+
+    const size_t prs = m_row_stride(Phi), pcs = m_col_stride(Phi);
+    for (size_t m = 0; m < n; m++) {
+        const m_data_t *row = Phi->data + m*prs;
+        m_data_t s = 0.0;
+        for (size_t k = 0; k < n; k++)
+            s += row[k*pcs]*cur_st->data[k];
+        next_st->data[m] = s;
+    }
+
+    if (Gamma) {
+        const size_t grs = m_row_stride(Gamma), gcs = m_col_stride(Gamma);
+        for (size_t m = 0; m < n; m++) {
+            const m_data_t *row = Gamma->data + m*grs;
+            m_data_t s = 0.0;
+            for (size_t k = 0; k < Gamma->cols; k++)
+                s += row[k*gcs]*cur_ctrl->data[k];
+            next_st->data[m] += s;
+        }
+    }
+
+    return E_OK;
+}
+
+/****
+ * The cache.
+ *
+ * A lookup packs the contents of A, B, Qc and dt into one key buffer, hashes
+ * it, and compares it against the entries with the same hash.  Entries are
+ * replaced round robin.
+ ****/
+
+typedef struct lti_cache_entry {
+    bool used;
+    uint64_t hash;
+    m_data_t *key;
+    lti_discrete_t *disc;
+} lti_cache_entry_t;
+
+struct lti_cache {
+    size_t n_states;
+    size_t n_ctrl;
+    bool noise;
+
+    size_t key_len;
+    m_data_t *key;
+
+    lti_cache_entry_t *entries;
+    size_t capacity;
+    size_t next;
+};
+
+lti_cache_t* lti_cache_new(size_t n_states, size_t n_ctrl, bool noise, size_t capacity)
+{
+    lti_cache_t *cache = NULL;
+
+    if (!n_states || !capacity) return NULL;
+
+    cache = calloc(1, sizeof *cache);
+    if (!cache) return NULL;
+
+    cache->n_states = n_states;
+    cache->n_ctrl = n_ctrl;
+    cache->noise = noise;
+    cache->capacity = capacity;
+    cache->key_len = n_states*n_states + n_states*n_ctrl + (noise ? n_states*n_states : 0) + 1;
+
+    cache->key = malloc(cache->key_len*sizeof *cache->key);
+    cache->entries = calloc(capacity, sizeof *cache->entries);
+    if (!cache->key || !cache->entries) {
+        lti_cache_del(cache);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < capacity; i++) {
+        lti_cache_entry_t *e = &cache->entries[i];
+        e->key = malloc(cache->key_len*sizeof *e->key);
+        e->disc = lti_discrete_new(n_states, n_ctrl, noise);
+        if (!e->key || !e->disc) {
+            lti_cache_del(cache);
+            return NULL;
+        }
+    }
+
+    return cache;
+}
+
+error_t lti_cache_del(lti_cache_t *cache)
+{
+    if (!cache) return E_OK;
+
+    if (cache->entries) {
+        for (size_t i = 0; i < cache->capacity; i++) {
+            free(cache->entries[i].key);
+            lti_discrete_del(cache->entries[i].disc);
+        }
+    }
+    free(cache->entries);
+    free(cache->key);
+    free(cache);
+
+    return E_OK;
+}
+
+/* Unsafe - does no checks.
+
+   Appends the entries of mat to key, returning the end of what was written.
+*/
+static m_data_t* lti_cache_pack(m_data_t *key, m_t *mat)
+{
+    for (size_t m = 0; m < mat->rows; m++)
+        for (size_t k = 0; k < mat->cols; k++)
+            *key++ = m_get(mat, m, k);
+    return key;
+}
+
+/* FNV-1a over the bytes of the key. */
+static uint64_t lti_cache_hash(const m_data_t *key, size_t len)
+{
+    const unsigned char *bytes = (const unsigned char *)key;
+    uint64_t h = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < len*sizeof *key; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+error_t lti_cache_get(lti_cache_t *cache, m_t *A, m_t *B, m_t *Qc, float dt, lti_discrete_t **disc)
+{
+    if (!cache || !A || !disc) return E_NULLP;
+
+    const size_t n = cache->n_states;
+    if (A->rows != n || A->cols != n) return E_VAL;
+    if (!B != !cache->n_ctrl || (B && (B->rows != n || B->cols != cache->n_ctrl))) return E_VAL;
+    if (!Qc != !cache->noise || (Qc && (Qc->rows != n || Qc->cols != n))) return E_VAL;
+
+    m_data_t *end = lti_cache_pack(cache->key, A);
+    if (B) end = lti_cache_pack(end, B);
+    if (Qc) end = lti_cache_pack(end, Qc);
+    *end = dt;
+
+    const uint64_t hash = lti_cache_hash(cache->key, cache->key_len);
+    for (size_t i = 0; i < cache->capacity; i++) {
+        lti_cache_entry_t *e = &cache->entries[i];
+        if (e->used && e->hash == hash && !memcmp(e->key, cache->key, cache->key_len*sizeof *e->key)) {
+            *disc = e->disc;
+            return E_OK;
+        }
+    }
+
+    lti_cache_entry_t *e = &cache->entries[cache->next];
+    e->used = false;
+    if (E_OK != lti_discretize(A, B, Qc, dt, e->disc)) return E_ERR;
+
+    memcpy(e->key, cache->key, cache->key_len*sizeof *e->key);
+    e->hash = hash;
+    e->used = true;
+    cache->next = (cache->next + 1) % cache->capacity;
+
+    *disc = e->disc;
+    return E_OK;
+}
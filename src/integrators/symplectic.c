@@ -0,0 +1,205 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "integrators/symplectic.h"
+
+/* Yoshida (1990), w1 = 1/(2 - 2^(1/3)) and w0 = 1 - 2*w1. */
+static const double yoshida4_w[] = {
+    1.3512071919596576340476878,
+    -1.7024143839193152680953756,
+    1.3512071919596576340476878,
+};
+static const size_t yoshida4_n = sizeof yoshida4_w/sizeof yoshida4_w[0];
+
+/* Suzuki (1990), p = 1/(4 - 4^(1/3)) with 1 - 4p in the middle. */
+static const double suzuki4_w[] = {
+    0.4144907717943757371423541,
+    0.4144907717943757371423541,
+    -0.6579630871775029485694163,
+    0.4144907717943757371423541,
+    0.4144907717943757371423541,
+};
+static const size_t suzuki4_n = sizeof suzuki4_w/sizeof suzuki4_w[0];
+
+/* Yoshida (1990) solution A, w0 = 1 - 2*(w1 + w2 + w3). */
+static const double yoshida6_w[] = {
+    0.784513610477560,
+    0.235573213359357,
+    -1.17767998417887,
+    1.315186320683906,
+    -1.17767998417887,
+    0.235573213359357,
+    0.784513610477560,
+};
+static const size_t yoshida6_n = sizeof yoshida6_w/sizeof yoshida6_w[0];
+
+struct integrator_verlet {
+    /* a was evaluated by fn at pos with ctrl, and is valid if cached is set. */
+    bool cached;
+    accel_fn fn;
+    v_t *pos;
+    v_t *ctrl;
+    bool has_ctrl;
+    v_t *a;
+};
+
+/* Unsafe - does no checks.
+
+   One kick-drift-kick step.  If have_a is set a already holds the
+   acceleration at pos, otherwise it is evaluated first.  On success a holds
+   the acceleration at the new pos.
+*/
+static error_t verlet_step(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl, v_t *a, bool have_a)
+{
+    const size_t n = pos->len;
+
+    if (!have_a && E_OK != fn(pos, cur_ctrl, a)) return E_ERR;
+    for (size_t i=0; i < n; i++) {
+        vel->data[i] += 0.5*dt*a->data[i];
+        pos->data[i] += dt*vel->data[i];
+    }
+
+    if (E_OK != fn(pos, cur_ctrl, a)) return E_ERR;
+    for (size_t i=0; i < n; i++)
+        vel->data[i] += 0.5*dt*a->data[i];
+
+    return E_OK;
+}
+
+error_t integrator_velocity_verlet(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl)
+{
+    if (!fn || !pos || !vel) return E_NULLP;
+    if (pos->len != vel->len) return E_VAL;
+
+    const size_t n = pos->len;
+    v_data_t a_data[n];
+    v_t a = { .len = n, .data = a_data };
+
+    return verlet_step(fn, dt, pos, vel, cur_ctrl, &a, false);
+}
+
+integrator_verlet_t* integrator_verlet_new(size_t len, size_t ctrl_len)
+{
+    integrator_verlet_t *v = NULL;
+
+    if (!len) return NULL;
+
+    v = calloc(1, sizeof *v);
+    if (!v) return NULL;
+
+    v->pos = v_new(len);
+    v->a = v_new(len);
+    if (ctrl_len) v->ctrl = v_new(ctrl_len);
+
+    if (!v->pos || !v->a || (ctrl_len && !v->ctrl)) {
+        integrator_verlet_del(v);
+        return NULL;
+    }
+
+    return v;
+}
+
+error_t integrator_verlet_del(integrator_verlet_t *v)
+{
+    if (!v) return E_OK;
+
+    v_del(v->pos);
+    v_del(v->ctrl);
+    v_del(v->a);
+    free(v);
+
+    return E_OK;
+}
+
+error_t integrator_verlet_reset(integrator_verlet_t *v)
+{
+    if (!v) return E_NULLP;
+
+    v->cached = false;
+    return E_OK;
+}
+
+/* Unsafe - does no checks.
+
+   Whether v->a is the acceleration fn gives at pos with cur_ctrl.
+*/
+static bool verlet_cache_hit(integrator_verlet_t *v, accel_fn fn, v_t *pos, v_t *cur_ctrl)
+{
+    if (!v->cached || v->fn != fn) return false;
+    if (memcmp(v->pos->data, pos->data, pos->len*sizeof *pos->data)) return false;
+    if (!cur_ctrl || !cur_ctrl->len) return !v->has_ctrl;
+
+    return v->has_ctrl && !memcmp(v->ctrl->data, cur_ctrl->data, cur_ctrl->len*sizeof *cur_ctrl->data);
+}
+
+error_t integrator_verlet_step(integrator_verlet_t *v, accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl)
+{
+    error_t err = E_OK;
+
+    if (!v || !fn || !pos || !vel) return E_NULLP;
+    if (pos->len != v->pos->len || vel->len != v->pos->len) return E_VAL;
+    if (cur_ctrl && cur_ctrl->len != (v->ctrl ? v->ctrl->len : 0)) return E_VAL;
+
+    const bool hit = verlet_cache_hit(v, fn, pos, cur_ctrl);
+
+    v->cached = false;
+    err = verlet_step(fn, dt, pos, vel, cur_ctrl, v->a, hit);
+    if (err != E_OK) return err;
+
+    memcpy(v->pos->data, pos->data, pos->len*sizeof *pos->data);
+    v->has_ctrl = cur_ctrl && cur_ctrl->len;
+    if (v->has_ctrl)
+        memcpy(v->ctrl->data, cur_ctrl->data, cur_ctrl->len*sizeof *cur_ctrl->data);
+    v->fn = fn;
+    v->cached = true;
+
+    return E_OK;
+}
+
+error_t integrator_composition(const double *w, size_t n_weights,
+                               accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl)
+{
+    if (!w || !fn || !pos || !vel) return E_NULLP;
+    if (!n_weights) return E_VAL;
+    if (pos->len != vel->len) return E_VAL;
+
+    const size_t n = pos->len;
+    v_data_t a_data[n];
+    v_t a = { .len = n, .data = a_data };
+
+    /* drift(w0/2) kick(w0) drift((w0+w1)/2) kick(w1) ... kick(wk) drift(wk/2) */
+    double drift = 0.5*w[0]*dt;
+    for (size_t s=0; s < n_weights; s++) {
+        for (size_t i=0; i < n; i++)
+            pos->data[i] += drift*vel->data[i];
+
+        if (E_OK != fn(pos, cur_ctrl, &a)) return E_ERR;
+
+        const double kick = w[s]*dt;
+        for (size_t i=0; i < n; i++)
+            vel->data[i] += kick*a.data[i];
+
+        drift = 0.5*(w[s] + (s+1 < n_weights ? w[s+1] : 0.0))*dt;
+    }
+
+    for (size_t i=0; i < n; i++)
+        pos->data[i] += drift*vel->data[i];
+
+    return E_OK;
+}
+
+error_t integrator_yoshida4(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl)
+{
+    return integrator_composition(yoshida4_w, yoshida4_n, fn, dt, pos, vel, cur_ctrl);
+}
+
+error_t integrator_suzuki4(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl)
+{
+    return integrator_composition(suzuki4_w, suzuki4_n, fn, dt, pos, vel, cur_ctrl);
+}
+
+error_t integrator_yoshida6(accel_fn fn, float dt, v_t *pos, v_t *vel, v_t *cur_ctrl)
+{
+    return integrator_composition(yoshida6_w, yoshida6_n, fn, dt, pos, vel, cur_ctrl);
+}
@@ -0,0 +1,121 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "linear_algebra/batch.h"
+
+/* Entry (m, n) of every matrix in the batch. */
+static inline m_data_t* la_batch_entry(m_batch_t *batch, size_t m, size_t n)
+{
+    return batch->data + (m*batch->cols + n)*batch->count;
+}
+
+error_t la_batch_cholesky(m_batch_t* A, m_batch_t* L)
+{
+    if (!A || !L) return E_NULLP;
+    if (A->rows != A->cols) return E_VAL;
+    if (!m_batch_same_size(A, L)) return E_VAL;
+
+    const size_t n = A->rows, count = A->count;
+
+    /* Same column by column algorithm as la_decompositions_cholesky, with
+       every scalar operation done across the whole batch.
+    */
+    for (size_t j = 0; j < n; j++) {
+        for (size_t i = j; i < n; i++) {
+            const m_data_t * restrict a = la_batch_entry(A, i, j);
+            m_data_t * restrict l = la_batch_entry(L, i, j);
+
+            if (l != a) {
+                for (size_t b = 0; b < count; b++) {
+                    l[b] = a[b];
+                }
+            }
+
+            for (size_t k = 0; k < j; k++) {
+                const m_data_t * restrict l_ik = la_batch_entry(L, i, k);
+                const m_data_t * restrict l_jk = la_batch_entry(L, j, k);
+                for (size_t b = 0; b < count; b++) {
+                    l[b] -= l_ik[b]*l_jk[b];
+                }
+            }
+        }
+
+        m_data_t * restrict l_jj = la_batch_entry(L, j, j);
+        for (size_t b = 0; b < count; b++) {
+            l_jj[b] = sqrt(l_jj[b]);
+        }
+
+        for (size_t i = j+1; i < n; i++) {
+            m_data_t * restrict l_ij = la_batch_entry(L, i, j);
+            for (size_t b = 0; b < count; b++) {
+                l_ij[b] /= l_jj[b];
+            }
+        }
+
+        for (size_t i = 0; i < j; i++) {
+            m_data_t * restrict l_ij = la_batch_entry(L, i, j);
+            for (size_t b = 0; b < count; b++) {
+                l_ij[b] = 0.0;
+            }
+        }
+    }
+
+    return E_OK;
+}
+
+error_t la_batch_cholesky_solve(m_batch_t* L, m_batch_t* B, m_batch_t* X)
+{
+    if (!L || !B || !X) return E_NULLP;
+    if (L->rows != L->cols) return E_VAL;
+    if (L->rows != B->rows || L->count != B->count) return E_VAL;
+    if (!m_batch_same_size(B, X)) return E_VAL;
+
+    const size_t n = L->rows, count = L->count;
+
+    for (size_t c = 0; c < B->cols; c++) {
+        /* Forward substitution, L Y = B.  Y goes into X. */
+        for (size_t i = 0; i < n; i++) {
+            const m_data_t * restrict b_ic = la_batch_entry(B, i, c);
+            m_data_t * restrict x_ic = la_batch_entry(X, i, c);
+
+            if (x_ic != b_ic) {
+                for (size_t b = 0; b < count; b++) {
+                    x_ic[b] = b_ic[b];
+                }
+            }
+
+            for (size_t p = 0; p < i; p++) {
+                const m_data_t * restrict l_ip = la_batch_entry(L, i, p);
+                const m_data_t * restrict x_pc = la_batch_entry(X, p, c);
+                for (size_t b = 0; b < count; b++) {
+                    x_ic[b] -= l_ip[b]*x_pc[b];
+                }
+            }
+
+            const m_data_t * restrict l_ii = la_batch_entry(L, i, i);
+            for (size_t b = 0; b < count; b++) {
+                x_ic[b] /= l_ii[b];
+            }
+        }
+
+        /* Back substitution, L^T X = Y, in place. */
+        for (size_t i = n; i-- > 0;) {
+            m_data_t * restrict x_ic = la_batch_entry(X, i, c);
+
+            for (size_t p = i+1; p < n; p++) {
+                const m_data_t * restrict l_pi = la_batch_entry(L, p, i);
+                const m_data_t * restrict x_pc = la_batch_entry(X, p, c);
+                for (size_t b = 0; b < count; b++) {
+                    x_ic[b] -= l_pi[b]*x_pc[b];
+                }
+            }
+
+            const m_data_t * restrict l_ii = la_batch_entry(L, i, i);
+            for (size_t b = 0; b < count; b++) {
+                x_ic[b] /= l_ii[b];
+            }
+        }
+    }
+
+    return E_OK;
+}
@@ -1,5 +1,296 @@
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
 #include "linear_algebra/decompositions.h"
 #include "linear_algebra/properties.h"
+#include "parallel/thread_pool.h"
+
+/* Square matricies at least this big are decomposed blockwise as a graph of
+   tasks on the thread pool.  Smaller ones use the simple serial loops.
+*/
+#define LA_BLOCKED_MIN_DIM 128
+/* Width of the block columns used by the blocked decompositions. */
+#define LA_BLOCK 48
+
+/****
+ * Blocked decompositions.
+ *
+ * Both Cholesky and Householder QR are split into block columns of LA_BLOCK
+ * columns each and run as the same task graph:
+ *
+ *   panel(k)     factors block column k.  Waits on update(k-1, k).
+ *   update(k, j) applies panel k to block column j > k.  Waits on panel(k)
+ *                and update(k-1, j).
+ *
+ * So panel(k+1) can start as soon as its own block column has been updated,
+ * overlapping with the rest of the trailing updates from panel k.  Every
+ * block column still sees the panels in order, which keeps the results the
+ * same no matter how many threads run the graph.
+ *
+ * The work is done on a dense row-major copy of the matrix in a.
+ ****/
+
+typedef struct la_blocked_ctx {
+    m_data_t *a;
+    size_t n;
+    /* Householder scalars for QR, one per column. */
+    m_data_t *tau;
+} la_blocked_ctx_t;
+
+static size_t la_block_end(const la_blocked_ctx_t *c, size_t k)
+{
+    return (k+1)*LA_BLOCK < c->n ? (k+1)*LA_BLOCK : c->n;
+}
+
+static error_t la_blocked_run(la_blocked_ctx_t *c, parallel_task_fn panel, parallel_task_fn update)
+{
+    const size_t nb = (c->n + LA_BLOCK - 1)/LA_BLOCK;
+    size_t last[nb];
+    error_t err = E_OK;
+
+    parallel_graph_t *g = parallel_graph_new(c);
+    if (!g) return E_ERR;
+
+    for (size_t k=0; k < nb && err == E_OK; k++) {
+        size_t pid;
+        err = parallel_graph_add(g, panel, k, k, &pid);
+        if (err == E_OK && k > 0) err = parallel_graph_depend(g, pid, last[k]);
+
+        for (size_t j=k+1; j < nb && err == E_OK; j++) {
+            size_t uid;
+            err = parallel_graph_add(g, update, k, j, &uid);
+            if (err == E_OK) err = parallel_graph_depend(g, uid, pid);
+            if (err == E_OK && k > 0) err = parallel_graph_depend(g, uid, last[j]);
+            last[j] = uid;
+        }
+    }
+
+    if (err == E_OK) err = parallel_graph_run(g);
+    parallel_graph_del(g);
+
+    return err;
+}
+
+static void la_cholesky_panel(void *ctx, size_t k, size_t unused)
+{
+    la_blocked_ctx_t *c = ctx;
+    m_data_t *a = c->a;
+    const size_t n = c->n, k0 = k*LA_BLOCK, k1 = la_block_end(c, k);
+    (void)unused;
+
+    for (size_t j=k0; j < k1; j++) {
+        for (size_t i=j; i < n; i++) {
+            m_data_t sum = 0.0;
+            for (size_t p=k0; p < j; p++) {
+                sum += a[i*n+p]*a[j*n+p];
+            }
+            a[i*n+j] -= sum;
+        }
+
+        const m_data_t d = sqrt(a[j*n+j]);
+        a[j*n+j] = d;
+        for (size_t i=j+1; i < n; i++) {
+            a[i*n+j] /= d;
+        }
+    }
+}
+
+static void la_cholesky_update(void *ctx, size_t k, size_t jb)
+{
+    la_blocked_ctx_t *c = ctx;
+    m_data_t *a = c->a;
+    const size_t n = c->n, k0 = k*LA_BLOCK, k1 = la_block_end(c, k);
+    const size_t j0 = jb*LA_BLOCK, j1 = la_block_end(c, jb);
+
+    for (size_t i=j0; i < n; i++) {
+        const size_t c1 = i+1 < j1 ? i+1 : j1;
+        for (size_t col=j0; col < c1; col++) {
+            m_data_t sum = 0.0;
+            for (size_t p=k0; p < k1; p++) {
+                sum += a[i*n+p]*a[col*n+p];
+            }
+            a[i*n+col] -= sum;
+        }
+    }
+}
+
+static error_t la_decompositions_cholesky_blocked(m_t* A, m_t* L)
+{
+    const size_t n = A->rows;
+    la_blocked_ctx_t c = { .n = n };
+    error_t err;
+
+    c.a = malloc(n*n*sizeof *c.a);
+    if (!c.a) return E_ERR;
+
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++) {
+            c.a[m*n+k] = k <= m ? m_get(A, m, k) : 0.0;
+        }
+    }
+
+    err = la_blocked_run(&c, la_cholesky_panel, la_cholesky_update);
+
+    for (size_t m = 0; m < n && err == E_OK; m++) {
+        for (size_t k = 0; k < n; k++) {
+            m_set(L, m, k, c.a[m*n+k]);
+        }
+    }
+
+    free(c.a);
+    return err;
+}
+
+/* Applies reflector j (stored below the diagonal of column j of a with its
+   scalar in tau[j]) to columns [c0, c1) of the n row matrix b.
+*/
+static void la_householder_apply(const la_blocked_ctx_t *c, size_t j,
+                                 m_data_t *b, size_t ldb, size_t c0, size_t c1)
+{
+    const m_data_t *a = c->a;
+    const size_t n = c->n;
+    const m_data_t beta = c->tau[j];
+    m_data_t s[LA_BLOCK];
+
+    if (beta == 0.0) return;
+
+    for (size_t col=c0; col < c1; col++) {
+        s[col-c0] = b[j*ldb+col];
+    }
+    for (size_t i=j+1; i < n; i++) {
+        const m_data_t v = a[i*n+j];
+        for (size_t col=c0; col < c1; col++) {
+            s[col-c0] += v*b[i*ldb+col];
+        }
+    }
+    for (size_t col=c0; col < c1; col++) {
+        s[col-c0] *= beta;
+        b[j*ldb+col] -= s[col-c0];
+    }
+    for (size_t i=j+1; i < n; i++) {
+        const m_data_t v = a[i*n+j];
+        for (size_t col=c0; col < c1; col++) {
+            b[i*ldb+col] -= s[col-c0]*v;
+        }
+    }
+}
+
+static void la_qr_panel(void *ctx, size_t k, size_t unused)
+{
+    la_blocked_ctx_t *c = ctx;
+    m_data_t *a = c->a;
+    const size_t n = c->n, k0 = k*LA_BLOCK, k1 = la_block_end(c, k);
+    (void)unused;
+
+    for (size_t j=k0; j < k1; j++) {
+        /* Householder vector with v[0] = 1 such that Hx = ||x||e1.  See
+           Golub & Van Loan, Algorithm 5.1.1.
+        */
+        const m_data_t x0 = a[j*n+j];
+        m_data_t sigma = 0.0;
+        for (size_t i=j+1; i < n; i++) {
+            sigma += a[i*n+j]*a[i*n+j];
+        }
+
+        if (sigma == 0.0) {
+            c->tau[j] = 0.0;
+        } else {
+            const m_data_t mu = sqrt(x0*x0 + sigma);
+            const m_data_t v0 = x0 <= 0 ? x0 - mu : -sigma/(x0 + mu);
+            c->tau[j] = 2*v0*v0/(sigma + v0*v0);
+            for (size_t i=j+1; i < n; i++) {
+                a[i*n+j] /= v0;
+            }
+            a[j*n+j] = mu;
+        }
+
+        la_householder_apply(c, j, a, n, j+1, k1);
+    }
+}
+
+static void la_qr_update(void *ctx, size_t k, size_t jb)
+{
+    la_blocked_ctx_t *c = ctx;
+    const size_t k0 = k*LA_BLOCK, k1 = la_block_end(c, k);
+    const size_t j0 = jb*LA_BLOCK, j1 = la_block_end(c, jb);
+
+    for (size_t j=k0; j < k1; j++) {
+        la_householder_apply(c, j, c->a, c->n, j0, j1);
+    }
+}
+
+typedef struct la_qr_form_ctx {
+    la_blocked_ctx_t *c;
+    m_data_t *q;
+} la_qr_form_ctx_t;
+
+/* Builds block column jb of Q = H_0 H_1 ... H_{n-1} I. */
+static void la_qr_form_q(void *ctx, size_t jb, size_t unused)
+{
+    la_qr_form_ctx_t *f = ctx;
+    const size_t n = f->c->n, j0 = jb*LA_BLOCK, j1 = la_block_end(f->c, jb);
+    (void)unused;
+
+    for (size_t i=0; i < n; i++) {
+        for (size_t col=j0; col < j1; col++) {
+            f->q[i*n+col] = i == col ? 1.0 : 0.0;
+        }
+    }
+
+    for (size_t j=n; j-- > 0;) {
+        la_householder_apply(f->c, j, f->q, n, j0, j1);
+    }
+}
+
+static error_t la_decompositions_qr_blocked(m_t* A, m_t* Q, m_t* R)
+{
+    const size_t n = A->rows, nb = (n + LA_BLOCK - 1)/LA_BLOCK;
+    la_blocked_ctx_t c = { .n = n };
+    la_qr_form_ctx_t f = { .c = &c };
+    parallel_graph_t *g = NULL;
+    error_t err = E_ERR;
+
+    c.a = malloc(n*n*sizeof *c.a);
+    c.tau = malloc(n*sizeof *c.tau);
+    f.q = malloc(n*n*sizeof *f.q);
+    if (!c.a || !c.tau || !f.q) goto out;
+
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++) {
+            c.a[m*n+k] = m_get(A, m, k);
+        }
+    }
+
+    err = la_blocked_run(&c, la_qr_panel, la_qr_update);
+    if (err != E_OK) goto out;
+
+    /* The block columns of Q are independent of each other. */
+    err = E_ERR;
+    g = parallel_graph_new(&f);
+    if (!g) goto out;
+    for (size_t jb = 0; jb < nb; jb++) {
+        if (E_OK != parallel_graph_add(g, la_qr_form_q, jb, 0, NULL)) goto out;
+    }
+    if (E_OK != parallel_graph_run(g)) goto out;
+
+    /* Match the Gram-Schmidt convention of a non-negative diagonal in R. */
+    for (size_t m = 0; m < n; m++) {
+        const m_data_t sign = c.a[m*n+m] < 0 ? -1.0 : 1.0;
+        for (size_t k = 0; k < n; k++) {
+            m_set(R, m, k, k >= m ? sign*c.a[m*n+k] : 0.0);
+            m_set(Q, k, m, sign*f.q[k*n+m]);
+        }
+    }
+    err = E_OK;
+
+    out:
+    parallel_graph_del(g);
+    free(c.a);
+    free(c.tau);
+    free(f.q);
+    return err;
+}
 
 error_t la_decompositions_cholesky(m_t* A, m_t* L) {
     if (!A || !L) {
@@ -18,6 +309,10 @@ error_t la_decompositions_cholesky(m_t* A, m_t* L) {
         return E_VAL;
     }
 
+    if (A->rows >= LA_BLOCKED_MIN_DIM) {
+        return la_decompositions_cholesky_blocked(A, L);
+    }
+
     // Algorithm from here: https://en.wikipedia.org/wiki/Cholesky_decomposition#Computation
     /*
     for (i = 0; i < dimensionSize; i++) {
@@ -113,6 +408,10 @@ error_t la_decompositions_qr(m_t* A, m_t* Q, m_t* R) {
         return E_VAL;
     }
 
+    if (A->rows >= LA_BLOCKED_MIN_DIM) {
+        return la_decompositions_qr_blocked(A, Q, R);
+    }
+
     if (E_OK != m_set_all(R, 0)) {
         return E_ERR;
     }
@@ -134,4 +433,525 @@ error_t la_decompositions_qr(m_t* A, m_t* Q, m_t* R) {
     }
 
     return E_OK;
-}
\ No newline at end of file
+}
+/****
+ * Symmetric eigendecomposition.
+ *
+ * A is first reduced to a symmetric tridiagonal T = Q^T A Q with Householder
+ * reflections, stored GVL style below the subdiagonal of a dense row-major
+ * copy of A.  T is then diagonalized with implicit Wilkinson-shift QR,
+ * chasing the bulge down with Givens rotations.  When eigenvectors are
+ * wanted the rotations are accumulated into Q.
+ *
+ * For a few extreme eigenpairs the eigenvalues come from the same QR
+ * without any accumulation, and the eigenvectors of T by inverse iteration,
+ * which are then taken back through the reflectors.
+ ****/
+
+/* Maximum QR sweeps per eigenvalue before giving up. */
+#define LA_EIGEN_MAX_SWEEPS 30
+/* Inverse iteration steps per eigenvector.  With an accurate eigenvalue one
+   step is usually enough; the extra ones clean up clustered eigenvalues.
+*/
+#define LA_EIGEN_INVERSE_ITERS 3
+
+typedef struct la_tridiagonal {
+    size_t n;
+    /* Reflectors in the strictly lower part, below the subdiagonal. */
+    m_data_t *a;
+    m_data_t *tau;
+    /* Diagonal and subdiagonal of T. */
+    m_data_t *d;
+    m_data_t *e;
+} la_tridiagonal_t;
+
+static void la_tridiagonal_free(la_tridiagonal_t *t)
+{
+    free(t->a);
+    free(t->tau);
+    free(t->d);
+    free(t->e);
+}
+
+/* Copies A into t and reduces it to tridiagonal form.  See GVL algorithm
+   8.3.1: each step applies P = I - tau*v*v^T from both sides to the
+   trailing block using the symmetric rank 2 update A -= v*w^T + w*v^T.
+*/
+static error_t la_tridiagonalize(m_t* A, la_tridiagonal_t *t)
+{
+    const size_t n = A->rows;
+    m_data_t *p = NULL;
+
+    t->n = n;
+    t->a = malloc(n*n*sizeof *t->a);
+    t->tau = calloc(n, sizeof *t->tau);
+    t->d = malloc(n*sizeof *t->d);
+    t->e = calloc(n, sizeof *t->e);
+    p = malloc(n*sizeof *p);
+    if (!t->a || !t->tau || !t->d || !t->e || !p) {
+        free(p);
+        la_tridiagonal_free(t);
+        return E_ERR;
+    }
+
+    m_data_t *a = t->a;
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++) {
+            a[m*n+k] = m_get(A, m, k);
+        }
+    }
+
+    for (size_t k = 0; k + 2 < n; k++) {
+        const m_data_t x0 = a[(k+1)*n+k];
+        m_data_t sigma = 0.0;
+        for (size_t i = k+2; i < n; i++) {
+            sigma += a[i*n+k]*a[i*n+k];
+        }
+
+        t->e[k] = x0;
+        if (sigma == 0.0) {
+            continue;
+        }
+
+        /* v[k+1] is an implicit 1, the rest are stored in column k. */
+        const m_data_t mu = sqrt(x0*x0 + sigma);
+        const m_data_t v0 = x0 <= 0 ? x0 - mu : -sigma/(x0 + mu);
+        const m_data_t tau = 2*v0*v0/(sigma + v0*v0);
+        for (size_t i = k+2; i < n; i++) {
+            a[i*n+k] /= v0;
+        }
+        t->tau[k] = tau;
+        t->e[k] = mu;
+
+        /* p = tau*A22*v, then w = p - (tau/2)(p.v)v, kept in p. */
+        m_data_t pv = 0.0;
+        for (size_t i = k+1; i < n; i++) {
+            m_data_t s = a[i*n+k+1];
+            for (size_t j = k+2; j < n; j++) {
+                s += a[i*n+j]*a[j*n+k];
+            }
+            p[i] = tau*s;
+            pv += p[i]*(i == k+1 ? 1.0 : a[i*n+k]);
+        }
+        const m_data_t K = tau*pv/2;
+        for (size_t i = k+1; i < n; i++) {
+            p[i] -= K*(i == k+1 ? 1.0 : a[i*n+k]);
+        }
+
+        for (size_t i = k+1; i < n; i++) {
+            const m_data_t vi = i == k+1 ? 1.0 : a[i*n+k];
+            for (size_t j = k+1; j < n; j++) {
+                const m_data_t vj = j == k+1 ? 1.0 : a[j*n+k];
+                a[i*n+j] -= vi*p[j] + p[i]*vj;
+            }
+        }
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        t->d[k] = a[k*n+k];
+    }
+    if (n > 1) {
+        t->e[n-2] = a[(n-1)*n+n-2];
+    }
+
+    free(p);
+    return E_OK;
+}
+
+/* Unsafe - does no checks.
+
+   Applies reflector k to the length n vector y.
+*/
+static void la_tridiagonal_reflect(const la_tridiagonal_t *t, size_t k, m_data_t *y, size_t stride)
+{
+    const size_t n = t->n;
+    const m_data_t *a = t->a;
+
+    if (t->tau[k] == 0.0) {
+        return;
+    }
+
+    m_data_t s = y[(k+1)*stride];
+    for (size_t i = k+2; i < n; i++) {
+        s += a[i*n+k]*y[i*stride];
+    }
+    s *= t->tau[k];
+
+    y[(k+1)*stride] -= s;
+    for (size_t i = k+2; i < n; i++) {
+        y[i*stride] -= s*a[i*n+k];
+    }
+}
+
+/* Forms Q = P_0 P_1 ... P_{n-3} as a dense row-major n x n matrix. */
+static void la_tridiagonal_form_q(const la_tridiagonal_t *t, m_data_t *q)
+{
+    const size_t n = t->n;
+
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++) {
+            q[m*n+k] = m == k ? 1.0 : 0.0;
+        }
+    }
+
+    /* Going backwards only columns k+1 and up are ever touched. */
+    for (size_t k = n > 2 ? n-2 : 0; k-- > 0;) {
+        for (size_t j = k+1; j < n; j++) {
+            la_tridiagonal_reflect(t, k, &q[j], n);
+        }
+    }
+}
+
+/* Diagonalizes the tridiagonal in d and e in place with implicit symmetric
+   QR (GVL algorithm 8.3.3).  If z is not NULL the Givens rotations are
+   accumulated into its columns, z being n x n row-major.
+*/
+static error_t la_tridiagonal_qr(m_data_t *d, m_data_t *e, size_t n, m_data_t *z)
+{
+    const m_data_t eps = DBL_EPSILON;
+    size_t sweeps = 0;
+    size_t hi = n ? n-1 : 0;
+
+    while (hi > 0) {
+        if (fabs(e[hi-1]) <= eps*(fabs(d[hi-1]) + fabs(d[hi]))) {
+            e[hi-1] = 0.0;
+            hi--;
+            continue;
+        }
+
+        /* Find the start of the unreduced block ending at hi. */
+        size_t lo = hi-1;
+        while (lo > 0 && fabs(e[lo-1]) > eps*(fabs(d[lo-1]) + fabs(d[lo]))) {
+            lo--;
+        }
+        if (lo > 0) {
+            e[lo-1] = 0.0;
+        }
+
+        if (++sweeps > LA_EIGEN_MAX_SWEEPS*n) {
+            return E_ERR;
+        }
+
+        /* Wilkinson shift from the trailing 2x2. */
+        const m_data_t dd = (d[hi-1] - d[hi])/2;
+        const m_data_t b = e[hi-1];
+        const m_data_t mu = d[hi] - b*b/(dd + copysign(hypot(dd, b), dd));
+
+        m_data_t x = d[lo] - mu;
+        m_data_t y = e[lo];
+        for (size_t k = lo; k < hi; k++) {
+            const m_data_t r = hypot(x, y);
+            const m_data_t c = r == 0.0 ? 1.0 : x/r;
+            const m_data_t s = r == 0.0 ? 0.0 : -y/r;
+
+            if (k > lo) {
+                e[k-1] = r;
+            }
+
+            /* T = G^T T G on rows and columns k, k+1. */
+            const m_data_t dk = d[k], dk1 = d[k+1], ek = e[k];
+            d[k] = c*c*dk - 2*c*s*ek + s*s*dk1;
+            d[k+1] = s*s*dk + 2*c*s*ek + c*c*dk1;
+            e[k] = c*s*(dk - dk1) + (c*c - s*s)*ek;
+
+            if (k+1 < hi) {
+                /* The bulge lands at (k+2, k). */
+                x = e[k];
+                y = -s*e[k+1];
+                e[k+1] *= c;
+            }
+
+            if (z) {
+                for (size_t m = 0; m < n; m++) {
+                    const m_data_t zk = z[m*n+k], zk1 = z[m*n+k+1];
+                    z[m*n+k] = c*zk - s*zk1;
+                    z[m*n+k+1] = s*zk + c*zk1;
+                }
+            }
+        }
+    }
+
+    return E_OK;
+}
+
+/* Sorts d ascending, permuting the columns of z (if not NULL) to match. */
+static void la_eigen_sort(m_data_t *d, m_data_t *z, size_t n)
+{
+    for (size_t i = 0; i + 1 < n; i++) {
+        size_t min = i;
+        for (size_t j = i+1; j < n; j++) {
+            if (d[j] < d[min]) {
+                min = j;
+            }
+        }
+        if (min == i) {
+            continue;
+        }
+
+        const m_data_t tmp = d[i];
+        d[i] = d[min];
+        d[min] = tmp;
+        if (z) {
+            for (size_t m = 0; m < n; m++) {
+                const m_data_t zt = z[m*n+i];
+                z[m*n+i] = z[m*n+min];
+                z[m*n+min] = zt;
+            }
+        }
+    }
+}
+
+/* Unsafe - does no checks.
+
+   Solves (T - lambda I) y = y in place for the tridiagonal in d and e using
+   LU with partial pivoting, like LAPACK's dgttrf/dgtts2.  Exactly singular
+   pivots are nudged to tiny so an exact eigenvalue still works.  lu needs
+   room for 4n values.
+*/
+static void la_tridiagonal_shifted_solve(const m_data_t *d, const m_data_t *e, size_t n,
+                                         m_data_t lambda, m_data_t tiny, m_data_t *lu, m_data_t *y)
+{
+    m_data_t *dl = lu, *dg = lu + n, *du = lu + 2*n, *du2 = lu + 3*n;
+    bool swap[n];
+
+    for (size_t i = 0; i < n; i++) {
+        dg[i] = d[i] - lambda;
+        if (i + 1 < n) {
+            dl[i] = e[i];
+            du[i] = e[i];
+        }
+        du2[i] = 0.0;
+    }
+
+    for (size_t i = 0; i + 1 < n; i++) {
+        swap[i] = fabs(dg[i]) < fabs(dl[i]);
+        if (!swap[i]) {
+            if (dg[i] == 0.0) {
+                dg[i] = tiny;
+            }
+            dl[i] /= dg[i];
+            dg[i+1] -= dl[i]*du[i];
+        } else {
+            const m_data_t f = dg[i]/dl[i];
+            dg[i] = dl[i];
+            dl[i] = f;
+            const m_data_t tmp = du[i];
+            du[i] = dg[i+1];
+            dg[i+1] = tmp - f*dg[i+1];
+            if (i + 2 < n) {
+                du2[i] = du[i+1];
+                du[i+1] = -f*du[i+1];
+            }
+        }
+    }
+    if (n && dg[n-1] == 0.0) {
+        dg[n-1] = tiny;
+    }
+
+    for (size_t i = 0; i + 1 < n; i++) {
+        if (!swap[i]) {
+            y[i+1] -= dl[i]*y[i];
+        } else {
+            const m_data_t tmp = y[i];
+            y[i] = y[i+1];
+            y[i+1] = tmp - dl[i]*y[i];
+        }
+    }
+
+    for (size_t i = n; i-- > 0;) {
+        m_data_t s = y[i];
+        if (i + 1 < n) s -= du[i]*y[i+1];
+        if (i + 2 < n) s -= du2[i]*y[i+2];
+        y[i] = s/dg[i];
+    }
+}
+
+static void la_normalize(m_data_t *y, size_t n)
+{
+    m_data_t norm = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        norm += y[i]*y[i];
+    }
+    norm = sqrt(norm);
+    for (size_t i = 0; i < n; i++) {
+        y[i] /= norm;
+    }
+}
+
+error_t la_decompositions_symmetric_eigen(m_t* A, v_t* w, m_t* V) {
+    la_tridiagonal_t t;
+    m_data_t *q = NULL;
+    error_t err;
+
+    if (!A || !w) {
+        return E_NULLP;
+    }
+
+    if (!m_is_square(A) || w->len != A->rows) {
+        return E_VAL;
+    }
+
+    if (V && !m_same_size(A, V)) {
+        return E_VAL;
+    }
+
+    if (!la_is_hermitian(A)) {
+        return E_VAL;
+    }
+
+    if (E_OK != la_tridiagonalize(A, &t)) {
+        return E_ERR;
+    }
+
+    const size_t n = t.n;
+    if (V) {
+        q = malloc(n*n*sizeof *q);
+        if (!q) {
+            err = E_ERR;
+            goto out;
+        }
+        la_tridiagonal_form_q(&t, q);
+    }
+
+    err = la_tridiagonal_qr(t.d, t.e, n, q);
+    if (err != E_OK) {
+        goto out;
+    }
+    la_eigen_sort(t.d, q, n);
+
+    for (size_t k = 0; k < n; k++) {
+        w->data[k] = t.d[k];
+    }
+    if (V) {
+        for (size_t m = 0; m < n; m++) {
+            for (size_t k = 0; k < n; k++) {
+                m_set(V, m, k, q[m*n+k]);
+            }
+        }
+    }
+
+    out:
+    free(q);
+    la_tridiagonal_free(&t);
+    return err;
+}
+
+error_t la_decompositions_symmetric_eigen_extreme(m_t* A, size_t k, bool largest, v_t* w, m_t* V) {
+    la_tridiagonal_t t;
+    m_data_t *lambda = NULL, *e = NULL, *lu = NULL, *y = NULL;
+    error_t err = E_ERR;
+
+    if (!A || !w) {
+        return E_NULLP;
+    }
+
+    if (!m_is_square(A) || k == 0 || k > A->rows || w->len != k) {
+        return E_VAL;
+    }
+
+    if (V && (V->rows != A->rows || V->cols != k)) {
+        return E_VAL;
+    }
+
+    if (!la_is_hermitian(A)) {
+        return E_VAL;
+    }
+
+    if (E_OK != la_tridiagonalize(A, &t)) {
+        return E_ERR;
+    }
+
+    const size_t n = t.n;
+    lambda = malloc(n*sizeof *lambda);
+    e = malloc(n*sizeof *e);
+    if (!lambda || !e) {
+        goto out;
+    }
+
+    /* QR destroys the tridiagonal, inverse iteration still needs it. */
+    for (size_t i = 0; i < n; i++) {
+        lambda[i] = t.d[i];
+        e[i] = t.e[i];
+    }
+    if (E_OK != la_tridiagonal_qr(lambda, e, n, NULL)) {
+        goto out;
+    }
+    la_eigen_sort(lambda, NULL, n);
+
+    for (size_t j = 0; j < k; j++) {
+        w->data[j] = lambda[largest ? n-1-j : j];
+    }
+
+    if (!V) {
+        err = E_OK;
+        goto out;
+    }
+
+    lu = malloc(4*n*sizeof *lu);
+    y = malloc(n*k*sizeof *y);
+    if (!lu || !y) {
+        goto out;
+    }
+
+    m_data_t tnorm = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        const m_data_t row = fabs(t.d[i]) + (i > 0 ? fabs(t.e[i-1]) : 0.0) + (i + 1 < n ? fabs(t.e[i]) : 0.0);
+        tnorm = row > tnorm ? row : tnorm;
+    }
+    const m_data_t tiny = DBL_EPSILON*(tnorm > 0.0 ? tnorm : 1.0);
+    /* Eigenvalues closer than this are treated as a cluster whose vectors
+       need to be kept orthogonal to each other explicitly.
+    */
+    const m_data_t cluster = 1e-3*tnorm;
+
+    for (size_t j = 0; j < k; j++) {
+        m_data_t *yj = &y[j*n];
+        m_data_t shift = w->data[j];
+
+        /* Separate repeated eigenvalues slightly so each solve differs. */
+        if (j > 0 && fabs(shift - w->data[j-1]) < 10*tiny) {
+            shift = w->data[j-1] + (largest ? -10*tiny : 10*tiny);
+        }
+
+        /* A start vector that is unlikely to be orthogonal to anything. */
+        for (size_t i = 0; i < n; i++) {
+            yj[i] = 1.0 + 0.1*(m_data_t)((i*7919) % 13);
+        }
+
+        for (size_t iter = 0; iter < LA_EIGEN_INVERSE_ITERS; iter++) {
+            la_tridiagonal_shifted_solve(t.d, t.e, n, shift, tiny, lu, yj);
+            for (size_t p = 0; p < j; p++) {
+                if (fabs(w->data[p] - w->data[j]) > cluster) {
+                    continue;
+                }
+                m_data_t dot = 0.0;
+                for (size_t i = 0; i < n; i++) {
+                    dot += y[p*n+i]*yj[i];
+                }
+                for (size_t i = 0; i < n; i++) {
+                    yj[i] -= dot*y[p*n+i];
+                }
+            }
+            la_normalize(yj, n);
+        }
+    }
+
+    /* Back to eigenvectors of A: y = P_0 ... P_{n-3} y. */
+    for (size_t j = 0; j < k; j++) {
+        for (size_t r = n > 2 ? n-2 : 0; r-- > 0;) {
+            la_tridiagonal_reflect(&t, r, &y[j*n], 1);
+        }
+        for (size_t m = 0; m < n; m++) {
+            m_set(V, m, j, y[j*n+m]);
+        }
+    }
+    err = E_OK;
+
+    out:
+    free(lambda);
+    free(e);
+    free(lu);
+    free(y);
+    la_tridiagonal_free(&t);
+    return err;
+}
@@ -0,0 +1,232 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "linear_algebra/exponential.h"
+
+/* Largest 1-norm each Pade degree is accurate to double precision for
+   (Higham 2005, table 2.3).
+*/
+static const double theta_3 = 1.495585217958292e-2;
+static const double theta_5 = 2.539398330063230e-1;
+static const double theta_7 = 9.504178996162932e-1;
+static const double theta_9 = 2.097847961257068e0;
+static const double theta_13 = 5.371920351148152e0;
+
+/* Pade coefficients b_0 ... b_m for each degree. */
+static const double b_3[] = {120.0, 60.0, 12.0, 1.0};
+static const double b_5[] = {30240.0, 15120.0, 3360.0, 420.0, 30.0, 1.0};
+static const double b_7[] = {17297280.0, 8648640.0, 1995840.0, 277200.0, 25200.0, 1512.0, 56.0, 1.0};
+static const double b_9[] = {17643225600.0, 8821612800.0, 2075673600.0, 302702400.0, 30270240.0,
+                             2162160.0, 110880.0, 3960.0, 90.0, 1.0};
+static const double b_13[] = {64764752532480000.0, 32382376266240000.0, 7771770303897600.0,
+                              1187353796428800.0, 129060195264000.0, 10559470521600.0,
+                              670442572800.0, 33522128640.0, 1323241920.0, 40840800.0,
+                              960960.0, 16380.0, 182.0, 1.0};
+
+/* All the scratch matricies are n x n and row-major, so elementwise work is
+   a flat loop over data.
+*/
+#define LA_EXPM_N_WORK 8
+
+/* Unsafe - does no checks.
+
+   res += s*mat, or res += s*I if mat is NULL.
+*/
+static void la_expm_axpy(m_t* res, m_data_t s, m_t* mat)
+{
+    const size_t n = res->rows;
+
+    if (!mat) {
+        for (size_t i = 0; i < n; i++) {
+            res->data[i*n+i] += s;
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n*n; i++) {
+        res->data[i] += s*mat->data[i];
+    }
+}
+
+static m_data_t la_norm_1(m_t* A)
+{
+    m_data_t norm = 0.0;
+    for (size_t n = 0; n < A->cols; n++) {
+        m_data_t sum = 0.0;
+        for (size_t m = 0; m < A->rows; m++) {
+            sum += fabs(A->data[m*A->cols+n]);
+        }
+        norm = sum > norm ? sum : norm;
+    }
+    return norm;
+}
+
+/* Solves Q X = P in place (X ends up in P) by Gaussian elimination with
+   partial pivoting.  Q is destroyed.
+*/
+static error_t la_expm_solve(m_t* Q, m_t* P)
+{
+    const size_t n = Q->rows;
+    m_data_t *q = Q->data, *p = P->data;
+
+    for (size_t k = 0; k < n; k++) {
+        size_t piv = k;
+        for (size_t m = k+1; m < n; m++) {
+            if (fabs(q[m*n+k]) > fabs(q[piv*n+k])) {
+                piv = m;
+            }
+        }
+        if (q[piv*n+k] == 0.0) {
+            return E_ERR;
+        }
+
+        if (piv != k) {
+            for (size_t j = 0; j < n; j++) {
+                m_data_t t = q[k*n+j]; q[k*n+j] = q[piv*n+j]; q[piv*n+j] = t;
+                t = p[k*n+j]; p[k*n+j] = p[piv*n+j]; p[piv*n+j] = t;
+            }
+        }
+
+        for (size_t m = k+1; m < n; m++) {
+            const m_data_t f = q[m*n+k]/q[k*n+k];
+            if (f == 0.0) {
+                continue;
+            }
+            for (size_t j = k+1; j < n; j++) {
+                q[m*n+j] -= f*q[k*n+j];
+            }
+            for (size_t j = 0; j < n; j++) {
+                p[m*n+j] -= f*p[k*n+j];
+            }
+        }
+    }
+
+    for (size_t k = n; k-- > 0;) {
+        for (size_t j = 0; j < n; j++) {
+            m_data_t s = p[k*n+j];
+            for (size_t m = k+1; m < n; m++) {
+                s -= q[k*n+m]*p[m*n+j];
+            }
+            p[k*n+j] = s/q[k*n+k];
+        }
+    }
+
+    return E_OK;
+}
+
+error_t la_expm(m_t* A, m_t* E) {
+    m_t* w[LA_EXPM_N_WORK] = {NULL};
+    error_t err = E_ERR;
+
+    if (!A || !E) {
+        return E_NULLP;
+    }
+
+    if (!m_is_square(A) || !m_same_size(A, E)) {
+        return E_VAL;
+    }
+
+    const size_t n = A->rows;
+    for (size_t i = 0; i < LA_EXPM_N_WORK; i++) {
+        w[i] = m_new(n, n);
+        if (!w[i]) {
+            goto out;
+        }
+    }
+
+    /* a holds A, pw A^2, A^4, A^6 and A^8, then u, v and t are the odd and
+       even parts of the approximant and a temporary.
+    */
+    m_t *a = w[0], **pw = &w[1], *u = w[5], *v = w[6], *t = w[7];
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++) {
+            a->data[m*n+k] = m_get(A, m, k);
+        }
+    }
+
+    const m_data_t norm = la_norm_1(a);
+    const double *b = b_13;
+    size_t degree = 13, squarings = 0;
+    if (norm <= theta_3) {
+        b = b_3; degree = 3;
+    } else if (norm <= theta_5) {
+        b = b_5; degree = 5;
+    } else if (norm <= theta_7) {
+        b = b_7; degree = 7;
+    } else if (norm <= theta_9) {
+        b = b_9; degree = 9;
+    } else if (norm > theta_13) {
+        squarings = (size_t)ceil(log2(norm/theta_13));
+        const m_data_t scale = ldexp(1.0, -(int)squarings);
+        for (size_t i = 0; i < n*n; i++) {
+            a->data[i] *= scale;
+        }
+    }
+
+    /* Degree 13 only needs up to A^6, the rest every even power below m. */
+    const size_t n_powers = degree == 13 ? 3 : (degree - 1)/2;
+    if (E_OK != m_mult(a, a, pw[0])) goto out;
+    for (size_t k = 1; k < n_powers; k++) {
+        if (E_OK != m_mult(pw[k-1], pw[0], pw[k])) goto out;
+    }
+
+    if (E_OK != m_set_all(t, 0.0) || E_OK != m_set_all(v, 0.0)) goto out;
+    if (degree < 13) {
+        /* t = sum b_odd A^(k-1), v = sum b_even A^k */
+        la_expm_axpy(t, b[1], NULL);
+        la_expm_axpy(v, b[0], NULL);
+        for (size_t k = 1; 2*k < degree; k++) {
+            la_expm_axpy(t, b[2*k+1], pw[k-1]);
+            la_expm_axpy(v, b[2*k], pw[k-1]);
+        }
+    } else {
+        /* Higham's evaluation, which gets away with 6 products. */
+        m_t *a2 = pw[0], *a4 = pw[1], *a6 = pw[2], *s = pw[3];
+
+        if (E_OK != m_set_all(s, 0.0)) goto out;
+        la_expm_axpy(s, b[13], a6);
+        la_expm_axpy(s, b[11], a4);
+        la_expm_axpy(s, b[9], a2);
+        if (E_OK != m_mult(a6, s, t)) goto out;
+        la_expm_axpy(t, b[7], a6);
+        la_expm_axpy(t, b[5], a4);
+        la_expm_axpy(t, b[3], a2);
+        la_expm_axpy(t, b[1], NULL);
+
+        if (E_OK != m_set_all(s, 0.0)) goto out;
+        la_expm_axpy(s, b[12], a6);
+        la_expm_axpy(s, b[10], a4);
+        la_expm_axpy(s, b[8], a2);
+        if (E_OK != m_mult(a6, s, v)) goto out;
+        la_expm_axpy(v, b[6], a6);
+        la_expm_axpy(v, b[4], a4);
+        la_expm_axpy(v, b[2], a2);
+        la_expm_axpy(v, b[0], NULL);
+    }
+    if (E_OK != m_mult(a, t, u)) goto out;
+
+    /* r = (v - u)^-1 (v + u), solved into t. */
+    for (size_t i = 0; i < n*n; i++) {
+        t->data[i] = v->data[i] + u->data[i];
+        v->data[i] -= u->data[i];
+    }
+    if (E_OK != la_expm_solve(v, t)) goto out;
+
+    for (size_t i = 0; i < squarings; i++) {
+        if (E_OK != m_mult(t, t, u)) goto out;
+        m_t *tmp = t; t = u; u = tmp;
+    }
+
+    for (size_t m = 0; m < n; m++) {
+        for (size_t k = 0; k < n; k++) {
+            m_set(E, m, k, t->data[m*n+k]);
+        }
+    }
+    err = E_OK;
+
+    out:
+    for (size_t i = 0; i < LA_EXPM_N_WORK; i++) {
+        m_del(w[i]);
+    }
+    return err;
+}
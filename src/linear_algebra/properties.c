@@ -2,11 +2,13 @@
 
 bool la_is_hermitian(m_t* A) {
     m_t* A_star = m_new(A->cols, A->rows);
+    bool hermitian = false;
 
-    if (E_OK != m_transpose(A, A_star)) {
-        return false;
+    if (A_star && E_OK == m_transpose(A, A_star)) {
+        hermitian = m_equal(A, A_star);
     }
 
-    return m_equal(A, A_star);
+    m_del(A_star);
+    return hermitian;
 }
 
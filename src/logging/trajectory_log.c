@@ -0,0 +1,325 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "logging/trajectory_log.h"
+
+/* Records are written and viewed as raw m_data_t, so the state and covariance
+   element types have to agree and map onto one of the log dtypes.
+*/
+typedef char traj_log_same_dtype_check[sizeof(v_data_t) == sizeof(m_data_t) ? 1 : -1];
+typedef char traj_log_header_size_check[sizeof(traj_log_header_t) == TRAJ_LOG_HEADER_SIZE ? 1 : -1];
+
+#define TRAJ_LOG_NATIVE_DTYPE (sizeof(m_data_t) == sizeof(double) ? TRAJ_LOG_F64 : TRAJ_LOG_F32)
+
+/* How long the writer thread sleeps when it finds the ring empty. */
+#define TRAJ_LOG_IDLE_NS 200000L
+
+struct traj_log_writer {
+    FILE *f;
+    pthread_t thread;
+    traj_log_header_t header;
+    size_t record_len;
+
+    /* The ring.  head is only written by the pushing thread and tail only by
+       the writer thread, each with release stores that the other side reads
+       with acquire loads.  Both count records pushed/popped and are masked to
+       get a slot.
+    */
+    m_data_t *ring;
+    size_t ring_mask;
+    size_t head;
+    size_t tail;
+
+    size_t pushed;
+    size_t dropped;
+    bool stop;
+    bool failed;
+};
+
+static size_t traj_log_record_len(size_t state_len, size_t cov_rows, size_t cov_cols)
+{
+    return 1 + state_len + cov_rows*cov_cols;
+}
+
+static void* traj_log_writer_thread(void *arg)
+{
+    traj_log_writer_t *w = arg;
+    const struct timespec idle = { .tv_sec = 0, .tv_nsec = TRAJ_LOG_IDLE_NS };
+
+    for (;;) {
+        /* Read stop before head so a record pushed right before close is
+           always seen by the final drain.
+        */
+        bool stop = __atomic_load_n(&w->stop, __ATOMIC_ACQUIRE);
+        size_t head = __atomic_load_n(&w->head, __ATOMIC_ACQUIRE);
+        size_t tail = w->tail;
+
+        if (head == tail) {
+            if (stop) break;
+            nanosleep(&idle, NULL);
+            continue;
+        }
+
+        /* Write the longest contiguous run of slots in one go. */
+        size_t slot = tail & w->ring_mask;
+        size_t count = head - tail;
+        if (count > w->ring_mask + 1 - slot) {
+            count = w->ring_mask + 1 - slot;
+        }
+
+        if (fwrite(w->ring + slot*w->record_len, w->header.record_size, count, w->f) != count) {
+            w->failed = true;
+        }
+
+        __atomic_store_n(&w->tail, tail + count, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+traj_log_writer_t* traj_log_writer_new(const char *path,
+                                       size_t state_len,
+                                       size_t cov_rows,
+                                       size_t cov_cols,
+                                       size_t ring_len,
+                                       size_t decimation)
+{
+    traj_log_writer_t *w = NULL;
+    size_t slots = 1;
+
+    if (!path || !state_len || !ring_len) goto fail;
+    if ((cov_rows == 0) != (cov_cols == 0)) goto fail;
+
+    while (slots < ring_len) slots <<= 1;
+
+    w = calloc(1, sizeof *w);
+    if (!w) goto fail;
+
+    w->record_len = traj_log_record_len(state_len, cov_rows, cov_cols);
+    w->ring_mask = slots - 1;
+    w->ring = malloc(slots*w->record_len*sizeof *w->ring);
+    if (!w->ring) goto fail_ring;
+
+    memcpy(w->header.magic, TRAJ_LOG_MAGIC, sizeof TRAJ_LOG_MAGIC);
+    w->header.version = TRAJ_LOG_VERSION;
+    w->header.byte_order = TRAJ_LOG_BYTE_ORDER;
+    w->header.dtype = TRAJ_LOG_NATIVE_DTYPE;
+    w->header.state_len = state_len;
+    w->header.cov_rows = cov_rows;
+    w->header.cov_cols = cov_cols;
+    w->header.record_size = w->record_len*sizeof(m_data_t);
+    w->header.decimation = decimation ? decimation : 1;
+
+    w->f = fopen(path, "wb");
+    if (!w->f) goto fail_f;
+
+    if (fwrite(&w->header, sizeof w->header, 1, w->f) != 1) goto fail_thread;
+    if (pthread_create(&w->thread, NULL, traj_log_writer_thread, w)) goto fail_thread;
+    goto out;
+
+    fail_thread:
+    fclose(w->f);
+
+    fail_f:
+    free(w->ring);
+
+    fail_ring:
+    free(w);
+
+    fail:
+    w = NULL;
+
+    out:
+    return w;
+}
+
+error_t traj_log_writer_push(traj_log_writer_t *w, double t, v_t *st, m_t *cov)
+{
+    if (!w || !st) return E_NULLP;
+    if (st->len != w->header.state_len) return E_VAL;
+    if (w->header.cov_rows) {
+        if (!cov) return E_NULLP;
+        if (cov->rows != w->header.cov_rows || cov->cols != w->header.cov_cols) return E_VAL;
+    }
+
+    if (w->pushed++ % w->header.decimation) return E_OK;
+
+    size_t head = w->head;
+    size_t tail = __atomic_load_n(&w->tail, __ATOMIC_ACQUIRE);
+    if (head - tail > w->ring_mask) {
+        w->dropped++;
+        return E_OK;
+    }
+
+    m_data_t *rec = w->ring + (head & w->ring_mask)*w->record_len;
+    rec[0] = (m_data_t)t;
+    memcpy(rec + 1, st->data, st->len*sizeof *rec);
+    if (w->header.cov_rows && cov->order == M_ROW_MAJOR) {
+        memcpy(rec + 1 + st->len, cov->data, cov->rows*cov->cols*sizeof *rec);
+    } else if (w->header.cov_rows) {
+        /* Logs are always row-major. */
+        const size_t rs = m_row_stride(cov), cs = m_col_stride(cov);
+        m_data_t *rec_cov = rec + 1 + st->len;
+        for (size_t m = 0; m < cov->rows; m++) {
+            for (size_t n = 0; n < cov->cols; n++) {
+                rec_cov[m*cov->cols+n] = cov->data[m*rs+n*cs];
+            }
+        }
+    }
+
+    __atomic_store_n(&w->head, head + 1, __ATOMIC_RELEASE);
+
+    return E_OK;
+}
+
+size_t traj_log_writer_dropped(const traj_log_writer_t *w)
+{
+    if (!w) return 0;
+    return w->dropped;
+}
+
+error_t traj_log_writer_close(traj_log_writer_t *w)
+{
+    error_t err = E_OK;
+
+    if (!w) return E_OK;
+
+    __atomic_store_n(&w->stop, true, __ATOMIC_RELEASE);
+    if (pthread_join(w->thread, NULL)) err = E_ERR;
+
+    if (w->failed) err = E_ERR;
+    if (fclose(w->f)) err = E_ERR;
+
+    free(w->ring);
+    free(w);
+
+    return err;
+}
+
+/* Whether an untrusted header describes a shape the writer could have made,
+   with a record_size that matches it.  Every step is checked for overflow
+   so a corrupt header can't wrap its way into a match.
+*/
+static bool traj_log_header_valid(const traj_log_header_t *h)
+{
+    uint64_t cov_len, len, size;
+
+    if (!h->state_len) return false;
+    if ((h->cov_rows == 0) != (h->cov_cols == 0)) return false;
+
+    if (__builtin_mul_overflow(h->cov_rows, h->cov_cols, &cov_len)) return false;
+    if (__builtin_add_overflow(h->state_len, cov_len, &len)) return false;
+    if (__builtin_add_overflow(len, 1, &len)) return false;
+    if (__builtin_mul_overflow(len, sizeof(m_data_t), &size)) return false;
+
+    return size > 0 && h->record_size == size;
+}
+
+struct traj_log_reader {
+    const unsigned char *map;
+    size_t map_len;
+    const traj_log_header_t *header;
+    size_t n_records;
+};
+
+traj_log_reader_t* traj_log_reader_open(const char *path)
+{
+    traj_log_reader_t *r = NULL;
+    const traj_log_header_t *h;
+    struct stat st;
+    void *map;
+    int fd;
+
+    if (!path) goto fail;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) goto fail;
+
+    if (fstat(fd, &st) || (size_t)st.st_size < TRAJ_LOG_HEADER_SIZE) goto fail_fd;
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) goto fail_fd;
+
+    h = map;
+    if (memcmp(h->magic, TRAJ_LOG_MAGIC, sizeof TRAJ_LOG_MAGIC)) goto fail_map;
+    if (h->version != TRAJ_LOG_VERSION) goto fail_map;
+    if (h->byte_order != TRAJ_LOG_BYTE_ORDER) goto fail_map;
+    if (h->dtype != TRAJ_LOG_NATIVE_DTYPE) goto fail_map;
+    if (!traj_log_header_valid(h)) goto fail_map;
+
+    r = malloc(sizeof *r);
+    if (!r) goto fail_map;
+
+    r->map = map;
+    r->map_len = (size_t)st.st_size;
+    r->header = h;
+    r->n_records = (r->map_len - TRAJ_LOG_HEADER_SIZE)/h->record_size;
+
+    /* The mapping stays valid after the descriptor is closed. */
+    close(fd);
+    goto out;
+
+    fail_map:
+    munmap(map, (size_t)st.st_size);
+
+    fail_fd:
+    close(fd);
+
+    fail:
+    r = NULL;
+
+    out:
+    return r;
+}
+
+error_t traj_log_reader_close(traj_log_reader_t *r)
+{
+    error_t err = E_OK;
+
+    if (!r) return E_OK;
+    if (munmap((void*)r->map, r->map_len)) err = E_ERR;
+    free(r);
+
+    return err;
+}
+
+const traj_log_header_t* traj_log_reader_header(const traj_log_reader_t *r)
+{
+    if (!r) return NULL;
+    return r->header;
+}
+
+size_t traj_log_reader_len(const traj_log_reader_t *r)
+{
+    if (!r) return 0;
+    return r->n_records;
+}
+
+error_t traj_log_reader_record(const traj_log_reader_t *r, size_t idx, traj_log_record_t *rec)
+{
+    if (!r || !rec) return E_NULLP;
+    if (idx >= r->n_records) return E_VAL;
+
+    /* The header size and record size are both multiples of sizeof(m_data_t)
+       and the mapping is page aligned, so these casts are properly aligned.
+    */
+    m_data_t *data = (m_data_t*)(r->map + TRAJ_LOG_HEADER_SIZE + idx*r->header->record_size);
+
+    rec->t = data[0];
+    rec->state.len = r->header->state_len;
+    rec->state.data = data + 1;
+    rec->cov.rows = r->header->cov_rows;
+    rec->cov.cols = r->header->cov_cols;
+    rec->cov.order = M_ROW_MAJOR;
+    rec->cov.data = r->header->cov_rows ? data + 1 + r->header->state_len : NULL;
+
+    return E_OK;
+}
@@ -0,0 +1,401 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multibody/multibody.h"
+
+/****
+ * Fixed size spatial kernels.  Spatial vectors are [angular; linear] and the
+ * 6x6 matricies are row-major.
+ ****/
+
+typedef v_data_t mb_vec6_t[6];
+typedef v_data_t mb_mat6_t[36];
+
+static void mb_cross(const v_data_t *a, const v_data_t *b, v_data_t *out)
+{
+    out[0] = a[1]*b[2] - a[2]*b[1];
+    out[1] = a[2]*b[0] - a[0]*b[2];
+    out[2] = a[0]*b[1] - a[1]*b[0];
+}
+
+/* out = [a]x, the 3x3 cross product matrix of a. */
+static void mb_skew(const v_data_t *a, v_data_t *out)
+{
+    out[0] = 0;     out[1] = -a[2]; out[2] = a[1];
+    out[3] = a[2];  out[4] = 0;     out[5] = -a[0];
+    out[6] = -a[1]; out[7] = a[0];  out[8] = 0;
+}
+
+/* Motion transform from rotation E and translation r: [E 0; -E[r]x E] */
+static void mb_xform(const v_data_t *E, const v_data_t *r, mb_mat6_t X)
+{
+    v_data_t rx[9];
+    mb_skew(r, rx);
+
+    memset(X, 0, sizeof(mb_mat6_t));
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            v_data_t erx = 0;
+            for (size_t k = 0; k < 3; k++) {
+                erx += E[i*3+k]*rx[k*3+j];
+            }
+            X[i*6+j] = E[i*3+j];
+            X[(i+3)*6+j+3] = E[i*3+j];
+            X[(i+3)*6+j] = -erx;
+        }
+    }
+}
+
+/* out = A*B.  out must not alias A or B. */
+static void mb_mat6_mult(const mb_mat6_t A, const mb_mat6_t B, mb_mat6_t out)
+{
+    for (size_t i = 0; i < 6; i++) {
+        for (size_t j = 0; j < 6; j++) {
+            v_data_t s = 0;
+            for (size_t k = 0; k < 6; k++) {
+                s += A[i*6+k]*B[k*6+j];
+            }
+            out[i*6+j] = s;
+        }
+    }
+}
+
+/* out = A*v */
+static void mb_mat6_vec(const mb_mat6_t A, const mb_vec6_t v, mb_vec6_t out)
+{
+    for (size_t i = 0; i < 6; i++) {
+        v_data_t s = 0;
+        for (size_t k = 0; k < 6; k++) {
+            s += A[i*6+k]*v[k];
+        }
+        out[i] = s;
+    }
+}
+
+/* out += A^T*v */
+static void mb_mat6_tvec_add(const mb_mat6_t A, const mb_vec6_t v, mb_vec6_t out)
+{
+    for (size_t i = 0; i < 6; i++) {
+        v_data_t s = 0;
+        for (size_t k = 0; k < 6; k++) {
+            s += A[k*6+i]*v[k];
+        }
+        out[i] += s;
+    }
+}
+
+/* out += X^T*I*X, moving an articulated inertia into the parent's frame. */
+static void mb_congruence_add(const mb_mat6_t X, const mb_mat6_t I, mb_mat6_t out)
+{
+    mb_mat6_t IX;
+    mb_mat6_mult(I, X, IX);
+
+    for (size_t i = 0; i < 6; i++) {
+        for (size_t j = 0; j < 6; j++) {
+            v_data_t s = 0;
+            for (size_t k = 0; k < 6; k++) {
+                s += X[k*6+i]*IX[k*6+j];
+            }
+            out[i*6+j] += s;
+        }
+    }
+}
+
+static v_data_t mb_dot6(const mb_vec6_t a, const mb_vec6_t b)
+{
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3] + a[4]*b[4] + a[5]*b[5];
+}
+
+/* out = v x m for motion vectors (crm in Featherstone). */
+static void mb_cross_motion(const mb_vec6_t v, const mb_vec6_t m, mb_vec6_t out)
+{
+    v_data_t t[3];
+    mb_cross(v, m, out);
+    mb_cross(v, m+3, out+3);
+    mb_cross(v+3, m, t);
+    out[3] += t[0];
+    out[4] += t[1];
+    out[5] += t[2];
+}
+
+/* out = v x* f for force vectors (crf in Featherstone). */
+static void mb_cross_force(const mb_vec6_t v, const mb_vec6_t f, mb_vec6_t out)
+{
+    v_data_t t[3];
+    mb_cross(v, f, out);
+    mb_cross(v+3, f+3, t);
+    out[0] += t[0];
+    out[1] += t[1];
+    out[2] += t[2];
+    mb_cross(v, f+3, out+3);
+}
+
+/* Spatial inertia about the body origin of a body with mass m, center of
+   mass c and rotational inertia Ic about c:
+   [Ic + m[c]x[c]x^T  m[c]x; m[c]x^T  m1]
+*/
+static void mb_inertia(v_data_t m, const v_data_t *c, const v_data_t *Ic, mb_mat6_t I)
+{
+    v_data_t cx[9];
+    mb_skew(c, cx);
+
+    memset(I, 0, sizeof(mb_mat6_t));
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            v_data_t cxcxt = 0;
+            for (size_t k = 0; k < 3; k++) {
+                cxcxt += cx[i*3+k]*cx[j*3+k];
+            }
+            I[i*6+j] = Ic[i*3+j] + m*cxcxt;
+            I[i*6+j+3] = m*cx[i*3+j];
+            I[(i+3)*6+j] = m*cx[j*3+i];
+        }
+        I[(i+3)*6+i+3] = m;
+    }
+}
+
+/****
+ * The model.
+ ****/
+
+/* Everything the algorithm works out for a body on each call. */
+typedef struct multibody_scratch {
+    /* Motion transform from the parent's frame to this body's. */
+    mb_mat6_t X_up;
+    mb_vec6_t S;
+    mb_vec6_t v;
+    mb_vec6_t c;
+    mb_vec6_t a;
+    mb_mat6_t IA;
+    mb_vec6_t pA;
+    mb_vec6_t U;
+    v_data_t d;
+    v_data_t u;
+} multibody_scratch_t;
+
+struct multibody {
+    size_t n;
+    multibody_body_t *bodies;
+    mb_mat6_t *X_tree;
+    mb_mat6_t *I;
+    multibody_scratch_t *s;
+    /* The base accelerates up at -gravity, which takes care of gravity for
+       every body without any per-body force.
+    */
+    mb_vec6_t a_base;
+};
+
+static __thread multibody_t *bound_model;
+
+multibody_t* multibody_new(const multibody_body_t *bodies, size_t n_bodies, const v_data_t gravity[3])
+{
+    multibody_t *model = NULL;
+
+    if (!bodies || !n_bodies || !gravity) return NULL;
+
+    for (size_t i = 0; i < n_bodies; i++) {
+        if (bodies[i].parent != MULTIBODY_BASE && bodies[i].parent >= i) return NULL;
+        if (bodies[i].joint != MULTIBODY_REVOLUTE && bodies[i].joint != MULTIBODY_PRISMATIC) return NULL;
+    }
+
+    model = calloc(1, sizeof *model);
+    if (!model) return NULL;
+
+    model->n = n_bodies;
+    model->bodies = malloc(n_bodies*sizeof *model->bodies);
+    model->X_tree = malloc(n_bodies*sizeof *model->X_tree);
+    model->I = malloc(n_bodies*sizeof *model->I);
+    model->s = calloc(n_bodies, sizeof *model->s);
+    if (!model->bodies || !model->X_tree || !model->I || !model->s) {
+        multibody_del(model);
+        return NULL;
+    }
+
+    memcpy(model->bodies, bodies, n_bodies*sizeof *bodies);
+    for (size_t i = 0; i < n_bodies; i++) {
+        const multibody_body_t *b = &bodies[i];
+        multibody_scratch_t *s = &model->s[i];
+
+        mb_xform(b->rot, b->pos, model->X_tree[i]);
+        mb_inertia(b->mass, b->com, b->inertia, model->I[i]);
+
+        /* The motion subspace is fixed in the body frame. */
+        const size_t off = b->joint == MULTIBODY_REVOLUTE ? 0 : 3;
+        s->S[off] = b->axis[0];
+        s->S[off+1] = b->axis[1];
+        s->S[off+2] = b->axis[2];
+    }
+
+    model->a_base[3] = -gravity[0];
+    model->a_base[4] = -gravity[1];
+    model->a_base[5] = -gravity[2];
+
+    return model;
+}
+
+error_t multibody_del(multibody_t *model)
+{
+    if (!model) return E_OK;
+
+    if (bound_model == model) bound_model = NULL;
+
+    free(model->bodies);
+    free(model->X_tree);
+    free(model->I);
+    free(model->s);
+    free(model);
+
+    return E_OK;
+}
+
+size_t multibody_dof(const multibody_t *model)
+{
+    return model ? model->n : 0;
+}
+
+/* Joint transform for joint position q, the transform from the joint's
+   frame at q = 0 to the body frame.
+*/
+static void multibody_joint_xform(const multibody_body_t *b, v_data_t q, mb_mat6_t XJ)
+{
+    const v_data_t *k = b->axis;
+    v_data_t E[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    v_data_t r[3] = {0, 0, 0};
+
+    if (b->joint == MULTIBODY_REVOLUTE) {
+        /* Rodrigues, transposed since E transforms coordinates:
+           E = 1 - sin(q)[k]x + (1 - cos(q))[k]x^2
+        */
+        v_data_t K[9];
+        const v_data_t s = sin(q), c1 = 1 - cos(q);
+        mb_skew(k, K);
+        for (size_t i = 0; i < 3; i++) {
+            for (size_t j = 0; j < 3; j++) {
+                const v_data_t K2 = K[i*3]*K[j] + K[i*3+1]*K[3+j] + K[i*3+2]*K[6+j];
+                E[i*3+j] += -s*K[i*3+j] + c1*K2;
+            }
+        }
+    } else {
+        r[0] = q*k[0];
+        r[1] = q*k[1];
+        r[2] = q*k[2];
+    }
+
+    mb_xform(E, r, XJ);
+}
+
+error_t multibody_forward_dynamics(multibody_t *model, v_t *q, v_t *qd, v_t *tau, v_t *qdd)
+{
+    if (!model || !q || !qd || !qdd) return E_NULLP;
+
+    const size_t n = model->n;
+    if (q->len != n || qd->len != n || qdd->len != n || (tau && tau->len != n)) return E_VAL;
+
+    /* Pass 1, root to leaves: velocities and velocity product terms. */
+    for (size_t i = 0; i < n; i++) {
+        const multibody_body_t *b = &model->bodies[i];
+        multibody_scratch_t *s = &model->s[i];
+        mb_mat6_t XJ;
+        mb_vec6_t vJ, t;
+
+        multibody_joint_xform(b, q->data[i], XJ);
+        mb_mat6_mult(XJ, model->X_tree[i], s->X_up);
+
+        for (size_t k = 0; k < 6; k++) {
+            vJ[k] = s->S[k]*qd->data[i];
+        }
+
+        if (b->parent == MULTIBODY_BASE) {
+            memcpy(s->v, vJ, sizeof s->v);
+            memset(s->c, 0, sizeof s->c);
+        } else {
+            mb_mat6_vec(s->X_up, model->s[b->parent].v, s->v);
+            for (size_t k = 0; k < 6; k++) {
+                s->v[k] += vJ[k];
+            }
+            mb_cross_motion(s->v, vJ, s->c);
+        }
+
+        memcpy(s->IA, model->I[i], sizeof s->IA);
+        mb_mat6_vec(model->I[i], s->v, t);
+        mb_cross_force(s->v, t, s->pA);
+    }
+
+    /* Pass 2, leaves to root: articulated inertias and bias forces. */
+    for (size_t i = n; i-- > 0;) {
+        const multibody_body_t *b = &model->bodies[i];
+        multibody_scratch_t *s = &model->s[i];
+
+        mb_mat6_vec(s->IA, s->S, s->U);
+        s->d = mb_dot6(s->S, s->U);
+        s->u = (tau ? tau->data[i] : 0) - mb_dot6(s->S, s->pA);
+
+        /* A joint moving nothing with any inertia can't be accelerated. */
+        if (s->d == 0) return E_VAL;
+        if (b->parent == MULTIBODY_BASE) continue;
+
+        multibody_scratch_t *p = &model->s[b->parent];
+        mb_mat6_t Ia;
+        mb_vec6_t pa;
+
+        for (size_t r = 0; r < 6; r++) {
+            for (size_t c = 0; c < 6; c++) {
+                Ia[r*6+c] = s->IA[r*6+c] - s->U[r]*s->U[c]/s->d;
+            }
+        }
+        mb_mat6_vec(Ia, s->c, pa);
+        for (size_t k = 0; k < 6; k++) {
+            pa[k] += s->pA[k] + s->U[k]*s->u/s->d;
+        }
+
+        mb_congruence_add(s->X_up, Ia, p->IA);
+        mb_mat6_tvec_add(s->X_up, pa, p->pA);
+    }
+
+    /* Pass 3, root to leaves: accelerations. */
+    for (size_t i = 0; i < n; i++) {
+        const multibody_body_t *b = &model->bodies[i];
+        multibody_scratch_t *s = &model->s[i];
+        const v_data_t *a_parent = b->parent == MULTIBODY_BASE ? model->a_base : model->s[b->parent].a;
+
+        mb_mat6_vec(s->X_up, a_parent, s->a);
+        for (size_t k = 0; k < 6; k++) {
+            s->a[k] += s->c[k];
+        }
+
+        qdd->data[i] = (s->u - mb_dot6(s->U, s->a))/s->d;
+        for (size_t k = 0; k < 6; k++) {
+            s->a[k] += s->S[k]*qdd->data[i];
+        }
+    }
+
+    return E_OK;
+}
+
+error_t multibody_bind(multibody_t *model)
+{
+    bound_model = model;
+    return E_OK;
+}
+
+error_t multibody_state_fn(v_t *cur_st, v_t *cur_ctrl, v_t *cur_st_rate)
+{
+    if (!bound_model) return E_NULLP;
+    if (!cur_st || !cur_st_rate) return E_NULLP;
+
+    const size_t n = bound_model->n;
+    if (cur_st->len != 2*n || cur_st_rate->len != 2*n) return E_VAL;
+    if (cur_st->data == cur_st_rate->data) return E_VAL;
+
+    /* Views of the halves of the state and its rate. */
+    v_t q = { .len = n, .data = cur_st->data };
+    v_t qd = { .len = n, .data = cur_st->data + n };
+    v_t qdd = { .len = n, .data = cur_st_rate->data + n };
+
+    for (size_t i = 0; i < n; i++) {
+        cur_st_rate->data[i] = qd.data[i];
+    }
+
+    return multibody_forward_dynamics(bound_model, &q, &qd, cur_ctrl, &qdd);
+}
@@ -0,0 +1,310 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "parallel/thread_pool.h"
+
+typedef struct parallel_task {
+    parallel_task_fn fn;
+    size_t i;
+    size_t j;
+
+    size_t n_deps;
+    size_t *succ;
+    size_t n_succ;
+    size_t succ_cap;
+} parallel_task_t;
+
+struct parallel_graph {
+    void *ctx;
+    parallel_task_t *tasks;
+    size_t n_tasks;
+    size_t tasks_cap;
+
+    /* Only used while running, all guarded by the pool lock.  Both are sized
+       to tasks_cap as tasks are added so running never allocates.
+    */
+    size_t *pending;
+    size_t *ready;
+    size_t ready_head;
+    size_t ready_tail;
+    size_t n_done;
+};
+
+/* There is exactly one pool.  Everyone waiting for something to happen
+   (workers waiting for tasks, the caller waiting for its graph to finish)
+   sleeps on cond.  run_lock keeps graphs from different callers from
+   overlapping.
+*/
+static struct {
+    pthread_mutex_t lock;
+    pthread_mutex_t run_lock;
+    pthread_cond_t cond;
+
+    pthread_t *workers;
+    size_t n_workers;
+    size_t n_threads;
+    bool started;
+    bool shutdown;
+    bool atexit_registered;
+
+    parallel_graph_t *graph;
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .run_lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+/* Set on pool threads and on a caller while it runs a graph, so nested
+   kernels know to stay serial.
+*/
+static __thread bool in_pool;
+
+size_t parallel_get_threads(void)
+{
+    if (pool.n_threads) return pool.n_threads;
+
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t)n : 1;
+}
+
+/****
+ * Graph running.  Everything here is called with pool.lock held.
+ ****/
+
+static bool graph_has_ready(const parallel_graph_t *g)
+{
+    return g->ready_head != g->ready_tail;
+}
+
+static bool graph_finished(const parallel_graph_t *g)
+{
+    return g->n_done == g->n_tasks;
+}
+
+/* Pops and runs ready tasks until there are none left.  The lock is dropped
+   while a task runs.
+*/
+static void graph_drain(parallel_graph_t *g)
+{
+    while (graph_has_ready(g)) {
+        const size_t id = g->ready[g->ready_head++];
+        const parallel_task_t *t = &g->tasks[id];
+
+        pthread_mutex_unlock(&pool.lock);
+        t->fn(g->ctx, t->i, t->j);
+        pthread_mutex_lock(&pool.lock);
+
+        bool woke = false;
+        for (size_t s = 0; s < t->n_succ; s++) {
+            if (--g->pending[t->succ[s]] == 0) {
+                g->ready[g->ready_tail++] = t->succ[s];
+                woke = true;
+            }
+        }
+        if (++g->n_done == g->n_tasks) woke = true;
+        if (woke) pthread_cond_broadcast(&pool.cond);
+    }
+}
+
+static void* pool_worker(void *arg)
+{
+    (void)arg;
+    in_pool = true;
+
+    pthread_mutex_lock(&pool.lock);
+    while (!pool.shutdown) {
+        if (pool.graph && graph_has_ready(pool.graph)) {
+            graph_drain(pool.graph);
+        } else {
+            pthread_cond_wait(&pool.cond, &pool.lock);
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return NULL;
+}
+
+static void pool_stop(void)
+{
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = true;
+    pthread_cond_broadcast(&pool.cond);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (size_t w = 0; w < pool.n_workers; w++) {
+        pthread_join(pool.workers[w], NULL);
+    }
+
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.n_workers = 0;
+    pool.shutdown = false;
+    pool.started = false;
+}
+
+/* Starts the workers.  Called with run_lock held. */
+static error_t pool_start(void)
+{
+    const size_t n_workers = parallel_get_threads() - 1;
+
+    if (!pool.atexit_registered) {
+        if (atexit(pool_stop)) return E_ERR;
+        pool.atexit_registered = true;
+    }
+
+    pool.workers = malloc(n_workers*sizeof *pool.workers);
+    if (!pool.workers) return E_ERR;
+
+    for (pool.n_workers = 0; pool.n_workers < n_workers; pool.n_workers++) {
+        if (pthread_create(&pool.workers[pool.n_workers], NULL, pool_worker, NULL)) {
+            pool_stop();
+            return E_ERR;
+        }
+    }
+
+    pool.started = true;
+    return E_OK;
+}
+
+error_t parallel_set_threads(size_t n_threads)
+{
+    pthread_mutex_lock(&pool.run_lock);
+    if (pool.started) pool_stop();
+    pool.n_threads = n_threads;
+    pthread_mutex_unlock(&pool.run_lock);
+
+    return E_OK;
+}
+
+/****
+ * Graph building.
+ ****/
+
+parallel_graph_t* parallel_graph_new(void *ctx)
+{
+    parallel_graph_t *g = calloc(1, sizeof *g);
+    if (!g) return NULL;
+
+    g->ctx = ctx;
+    return g;
+}
+
+error_t parallel_graph_del(parallel_graph_t *g)
+{
+    if (!g) return E_OK;
+
+    for (size_t t = 0; t < g->n_tasks; t++) {
+        free(g->tasks[t].succ);
+    }
+    free(g->tasks);
+    free(g->pending);
+    free(g->ready);
+    free(g);
+
+    return E_OK;
+}
+
+error_t parallel_graph_add(parallel_graph_t *g, parallel_task_fn fn, size_t i, size_t j, size_t *id)
+{
+    if (!g || !fn) return E_NULLP;
+
+    if (g->n_tasks == g->tasks_cap) {
+        size_t cap = g->tasks_cap ? 2*g->tasks_cap : 16;
+        parallel_task_t *tasks = realloc(g->tasks, cap*sizeof *tasks);
+        if (!tasks) return E_ERR;
+        g->tasks = tasks;
+
+        /* Buffers that grew stay grown if a later one fails, which is
+           harmless since tasks_cap only moves once all three have.
+        */
+        size_t *pending = realloc(g->pending, cap*sizeof *pending);
+        if (!pending) return E_ERR;
+        g->pending = pending;
+
+        size_t *ready = realloc(g->ready, cap*sizeof *ready);
+        if (!ready) return E_ERR;
+        g->ready = ready;
+
+        g->tasks_cap = cap;
+    }
+
+    g->tasks[g->n_tasks] = (parallel_task_t){ .fn = fn, .i = i, .j = j };
+    if (id) *id = g->n_tasks;
+    g->n_tasks++;
+
+    return E_OK;
+}
+
+error_t parallel_graph_depend(parallel_graph_t *g, size_t task, size_t on)
+{
+    if (!g) return E_NULLP;
+    if (task >= g->n_tasks || on >= task) return E_VAL;
+
+    parallel_task_t *t = &g->tasks[on];
+    if (t->n_succ == t->succ_cap) {
+        size_t cap = t->succ_cap ? 2*t->succ_cap : 4;
+        size_t *succ = realloc(t->succ, cap*sizeof *succ);
+        if (!succ) return E_ERR;
+        t->succ = succ;
+        t->succ_cap = cap;
+    }
+
+    t->succ[t->n_succ++] = task;
+    g->tasks[task].n_deps++;
+
+    return E_OK;
+}
+
+error_t parallel_graph_run(parallel_graph_t *g)
+{
+    if (!g) return E_NULLP;
+    if (!g->n_tasks) return E_OK;
+
+    g->ready_head = g->ready_tail = g->n_done = 0;
+    for (size_t t = 0; t < g->n_tasks; t++) {
+        g->pending[t] = g->tasks[t].n_deps;
+        if (!g->pending[t]) g->ready[g->ready_tail++] = t;
+    }
+
+    /* Nested in another graph, or nothing to share: just run it here.  The
+       lock still has to be held since graph_drain expects it.
+    */
+    if (in_pool || parallel_get_threads() < 2 || g->n_tasks < 2) {
+        const bool was_in_pool = in_pool;
+        in_pool = true;
+        pthread_mutex_lock(&pool.lock);
+        graph_drain(g);
+        pthread_mutex_unlock(&pool.lock);
+        in_pool = was_in_pool;
+        return E_OK;
+    }
+
+    pthread_mutex_lock(&pool.run_lock);
+    if (!pool.started && E_OK != pool_start()) {
+        pthread_mutex_unlock(&pool.run_lock);
+        return E_ERR;
+    }
+
+    in_pool = true;
+    pthread_mutex_lock(&pool.lock);
+    pool.graph = g;
+    pthread_cond_broadcast(&pool.cond);
+
+    /* Help out until the graph is done. */
+    while (!graph_finished(g)) {
+        if (graph_has_ready(g)) {
+            graph_drain(g);
+        } else {
+            pthread_cond_wait(&pool.cond, &pool.lock);
+        }
+    }
+
+    pool.graph = NULL;
+    pthread_mutex_unlock(&pool.lock);
+    in_pool = false;
+    pthread_mutex_unlock(&pool.run_lock);
+
+    return E_OK;
+}
@@ -0,0 +1,171 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/matrix.h"
+#include "parallel/thread_pool.h"
+
+void test_data_structures_matrix__initialize(void) {
+    global_test_counter++;
+}
+
+void test_data_structures_matrix__cleanup(void)
+{
+    parallel_set_threads(0);
+}
+
+static void fill(m_t *mat)
+{
+    for (size_t m = 0; m < mat->rows; m++)
+        for (size_t n = 0; n < mat->cols; n++)
+            m_set(mat, m, n, (m_data_t)(m*mat->cols + n) - 3.0);
+}
+
+void test_data_structures_matrix__storage_order(void)
+{
+    m_data_t buf[] = {1, 2, 3, 4, 5, 6};
+    m_t view;
+    m_t *row = m_new_ordered(2, 3, M_ROW_MAJOR);
+    m_t *col = m_new_ordered(2, 3, M_COL_MAJOR);
+    cl_assert(row && col);
+
+    cl_assert_equal_i_(m_init_view(NULL, 2, 3, M_COL_MAJOR, buf), E_NULLP, "m_init_view on NULL should fail.");
+    cl_assert_equal_i_(m_init_view(&view, 2, 3, (m_order_t)2, buf), E_VAL, "m_init_view should reject a bad order.");
+    cl_assert_(m_new_ordered(2, 3, (m_order_t)2) == NULL, "m_new_ordered should reject a bad order.");
+    cl_assert_equal_i(m_init_view(&view, 2, 3, M_COL_MAJOR, buf), E_OK);
+    cl_assert_(m_get(&view, 0, 1) == 3 && m_get(&view, 1, 0) == 2, "Column-major view indexed wrong.");
+
+    fill(row);
+    fill(col);
+    cl_assert_(m_equal(row, col), "The same entries in different orders should be equal.");
+    cl_assert_(col->data[1] == m_get(col, 1, 0), "Column-major data should have columns contiguous.");
+
+    m_del(row);
+    m_del(col);
+}
+
+void test_data_structures_matrix__mixed_order_kernels(void)
+{
+    const m_order_t orders[] = {M_ROW_MAJOR, M_COL_MAJOR};
+
+    for (size_t o = 0; o < 8; o++) {
+        m_t *lhs = m_new_ordered(3, 4, orders[o & 1]);
+        m_t *rhs = m_new_ordered(4, 2, orders[(o >> 1) & 1]);
+        m_t *res = m_new_ordered(3, 2, orders[(o >> 2) & 1]);
+        m_t *res_t = m_new_ordered(2, 3, orders[o & 1]);
+        m_t *sum = m_new_ordered(3, 2, orders[o & 1]);
+        m_t *ref_lhs = m_new(3, 4), *ref_rhs = m_new(4, 2), *ref = m_new(3, 2);
+        cl_assert(lhs && rhs && res && res_t && sum && ref_lhs && ref_rhs && ref);
+
+        fill(lhs); fill(ref_lhs);
+        fill(rhs); fill(ref_rhs);
+
+        cl_assert_equal_i(m_mult(ref_lhs, ref_rhs, ref), E_OK);
+        cl_assert_equal_i(m_mult(lhs, rhs, res), E_OK);
+        cl_assert_(m_equal(res, ref), "Mixed order multiply should match row-major.");
+
+        cl_assert_equal_i(m_add(res, ref, sum), E_OK);
+        for (size_t m = 0; m < 3; m++)
+            for (size_t n = 0; n < 2; n++)
+                cl_assert_(m_get(sum, m, n) == 2*m_get(ref, m, n), "Mixed order add failed.");
+
+        cl_assert_equal_i(m_transpose(res, res_t), E_OK);
+        for (size_t m = 0; m < 3; m++)
+            for (size_t n = 0; n < 2; n++)
+                cl_assert_(m_get(res_t, n, m) == m_get(ref, m, n), "Mixed order transpose failed.");
+
+        m_del(lhs); m_del(rhs); m_del(res); m_del(res_t); m_del(sum);
+        m_del(ref_lhs); m_del(ref_rhs); m_del(ref);
+    }
+}
+
+void test_data_structures_matrix__mixed_order_aliasing(void)
+{
+    m_t *s = m_new_ordered(3, 3, M_ROW_MAJOR);
+    m_t *t = m_new_ordered(3, 3, M_ROW_MAJOR);
+    m_t s_col;
+    cl_assert(s && t);
+    cl_assert_equal_i(m_init_view(&s_col, 3, 3, M_COL_MAJOR, s->data), E_OK);
+
+    cl_assert_equal_i_(m_add(s, t, &s_col), E_VAL, "Adding into lhs's storage in the other order should fail.");
+    cl_assert_equal_i_(m_add(t, s, &s_col), E_VAL, "Adding into rhs's storage in the other order should fail.");
+    cl_assert_equal_i_(m_negate(s, &s_col), E_VAL, "Negating into storage in the other order should fail.");
+
+    fill(s);
+    fill(t);
+    cl_assert_equal_i(m_add(s, t, s), E_OK);
+    cl_assert_equal_i(m_negate(&s_col, &s_col), E_OK);
+    for (size_t m = 0; m < 3; m++)
+        for (size_t n = 0; n < 3; n++)
+            cl_assert(m_get(s, m, n) == -2*((m_data_t)(m*3 + n) - 3.0));
+
+    m_del(s);
+    m_del(t);
+}
+
+void test_data_structures_matrix__column_ops(void)
+{
+    m_t *row = m_new_ordered(3, 2, M_ROW_MAJOR);
+    m_t *col = m_new_ordered(3, 2, M_COL_MAJOR);
+    m_data_t dot_row, dot_col;
+    cl_assert(row && col);
+
+    fill(row);
+    cl_assert_equal_i(m_set_all(col, 0.0), E_OK);
+    cl_assert_equal_i(m_copy_column(row, col, 1), E_OK);
+    cl_assert_equal_i_(m_copy_column(row, col, 2), E_VAL, "Copying a column past the end should fail.");
+    cl_assert_(m_get(col, 2, 1) == m_get(row, 2, 1) && m_get(col, 2, 0) == 0.0, "Only column 1 should be copied.");
+
+    cl_assert_equal_i(m_column_dot_product(row, 1, row, 1, &dot_row), E_OK);
+    cl_assert_equal_i(m_column_dot_product(col, 1, row, 1, &dot_col), E_OK);
+    cl_assert_(dot_row == dot_col, "Dot product shouldn't depend on order.");
+    cl_assert_equal_i_(m_column_dot_product(row, 0, col, 2, &dot_col), E_VAL, "Dot product past the end should fail.");
+
+    cl_assert_equal_i(m_normalize_column_l2(row, col, 1), E_OK);
+    cl_assert_(fabs(m_get(col, 1, 1) - m_get(row, 1, 1)/sqrt(dot_row)) < 1e-15, "Normalized column is wrong.");
+
+    m_del(row);
+    m_del(col);
+}
+
+void test_data_structures_matrix__mult_parallel(void)
+{
+    /* 130*90*100 is past the threshold for the tiled, threaded product. */
+    const size_t rows = 130, common = 90, cols = 100;
+    m_t *lhs = m_new_ordered(rows, common, M_ROW_MAJOR);
+    m_t *rhs = m_new_ordered(common, cols, M_COL_MAJOR);
+    m_t *res1 = m_new(rows, cols);
+    m_t *res4 = m_new(rows, cols);
+    cl_assert(lhs && rhs && res1 && res4);
+
+    for (size_t m = 0; m < rows; m++)
+        for (size_t k = 0; k < common; k++)
+            m_set(lhs, m, k, sin(1.0 + m*common + k));
+    for (size_t k = 0; k < common; k++)
+        for (size_t n = 0; n < cols; n++)
+            m_set(rhs, k, n, cos(1.0 + k*cols + n));
+
+    cl_assert_equal_i(parallel_set_threads(1), E_OK);
+    cl_assert_equal_i(m_mult(lhs, rhs, res1), E_OK);
+    cl_assert_equal_i(parallel_set_threads(4), E_OK);
+    cl_assert_equal_i(m_mult(lhs, rhs, res4), E_OK);
+
+    m_data_t err = 0;
+    for (size_t m = 0; m < rows; m++)
+        for (size_t n = 0; n < cols; n++) {
+            m_data_t s = 0, a = m_get(res1, m, n), b = m_get(res4, m, n);
+            for (size_t k = 0; k < common; k++)
+                s += m_get(lhs, m, k)*m_get(rhs, k, n);
+            err = fmax(err, fabs(s - b));
+            cl_assert_(memcmp(&a, &b, sizeof(a)) == 0, "m_mult should not depend on the thread count.");
+        }
+    cl_assert_(err < 1e-12, "Threaded m_mult disagrees with the naive product.");
+
+    m_del(lhs); m_del(rhs); m_del(res1); m_del(res4);
+}
@@ -0,0 +1,85 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/matrix.h"
+#include "data_structures/matrix_batch.h"
+
+void test_data_structures_matrix_batch__initialize(void) {
+    global_test_counter++;
+}
+
+void test_data_structures_matrix_batch__cleanup(void)
+{
+}
+
+static void fill(m_t *mat, size_t seed)
+{
+    for (size_t m = 0; m < mat->rows; m++)
+        for (size_t n = 0; n < mat->cols; n++)
+            m_set(mat, m, n, sin(1.0 + seed*31.0 + m*mat->cols + n));
+}
+
+void test_data_structures_matrix_batch__load_store(void)
+{
+    m_batch_t *batch = m_batch_new(2, 3, 5);
+    m_t *in = m_new_ordered(2, 3, M_COL_MAJOR), *out = m_new(2, 3);
+    cl_assert(batch && in && out);
+
+    fill(in, 4);
+    cl_assert_equal_i(m_batch_load(batch, 4, in), E_OK);
+    cl_assert_(batch->data[(1*3 + 2)*5 + 4] == m_get(in, 1, 2), "Entry (m, n) of matrix b should be at (m*cols + n)*count + b.");
+    cl_assert_(m_batch_get(batch, 4, 0, 1) == m_get(in, 0, 1), "m_batch_get should match what was loaded.");
+
+    cl_assert_equal_i(m_batch_set(batch, 4, 0, 1, 42.0), E_OK);
+    cl_assert_equal_i(m_batch_store(batch, 4, out), E_OK);
+    cl_assert_(m_get(out, 0, 1) == 42.0 && m_get(out, 1, 2) == m_get(in, 1, 2), "m_batch_store should copy matrix 4 out.");
+
+    cl_assert_equal_i_(m_batch_load(batch, 5, in), E_VAL, "Index past the batch should fail.");
+    cl_assert_equal_i_(m_batch_set(batch, 0, 2, 0, 1.0), E_VAL, "Row past the end should fail.");
+
+    m_del(in);
+    m_del(out);
+    m_batch_del(batch);
+}
+
+void test_data_structures_matrix_batch__mult_matches_m_mult(void)
+{
+    const size_t count = 7;
+    m_batch_t *lhs = m_batch_new(3, 4, count), *rhs = m_batch_new(4, 2, count), *res = m_batch_new(3, 2, count);
+    m_t *l = m_new(3, 4), *r = m_new(4, 2), *ref = m_new(3, 2), *got = m_new(3, 2);
+    cl_assert(lhs && rhs && res && l && r && ref && got);
+
+    for (size_t b = 0; b < count; b++) {
+        fill(l, b);
+        fill(r, b + 100);
+        cl_assert_equal_i(m_batch_load(lhs, b, l), E_OK);
+        cl_assert_equal_i(m_batch_load(rhs, b, r), E_OK);
+    }
+
+    cl_assert_equal_i(m_batch_mult(lhs, rhs, res), E_OK);
+
+    for (size_t b = 0; b < count; b++) {
+        fill(l, b);
+        fill(r, b + 100);
+        cl_assert_equal_i(m_mult(l, r, ref), E_OK);
+        cl_assert_equal_i(m_batch_store(res, b, got), E_OK);
+        for (size_t m = 0; m < 3; m++)
+            for (size_t n = 0; n < 2; n++)
+                cl_assert_(fabs(m_get(got, m, n) - m_get(ref, m, n)) < 1e-14, "Batch lane doesn't match m_mult.");
+    }
+
+    m_batch_t *sq = m_batch_new(2, 2, count);
+    cl_assert(sq);
+    cl_assert_equal_i_(m_batch_mult(sq, sq, sq), E_VAL, "res can't be lhs or rhs.");
+    m_batch_del(sq);
+    cl_assert_equal_i_(m_batch_mult(rhs, lhs, res), E_VAL, "Mismatched sizes should fail.");
+
+    m_batch_del(lhs); m_batch_del(rhs); m_batch_del(res);
+    m_del(l); m_del(r); m_del(ref); m_del(got);
+}
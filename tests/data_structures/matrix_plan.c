@@ -0,0 +1,171 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/matrix.h"
+#include "data_structures/matrix_plan.h"
+
+void test_data_structures_matrix_plan__initialize(void) {
+    global_test_counter++;
+}
+
+void test_data_structures_matrix_plan__cleanup(void)
+{
+}
+
+static void fill(m_t *mat, m_data_t offset)
+{
+    for (size_t m = 0; m < mat->rows; m++)
+        for (size_t n = 0; n < mat->cols; n++)
+            m_set(mat, m, n, offset + (m_data_t)(m*mat->cols + n));
+}
+
+void test_data_structures_matrix_plan__record_checks(void)
+{
+    m_plan_t *plan = m_plan_new(4);
+    m_t *a = m_new(2, 3);
+    m_t *b = m_new(3, 2);
+    m_t *c = m_new(2, 2);
+    cl_assert(plan && a && b && c);
+
+    cl_assert_equal_i_(m_plan_mult(NULL, a, b, c), E_NULLP, "Recording on a NULL plan should fail.");
+    cl_assert_equal_i_(m_plan_mult(plan, a, a, c), E_VAL, "Mismatched inner dimensions should fail.");
+    cl_assert_equal_i_(m_plan_mult(plan, c, c, c), E_VAL, "Aliased multiply output should fail.");
+    cl_assert_equal_i_(m_plan_add(plan, a, b, a), E_VAL, "Adding different sizes should fail.");
+    cl_assert_equal_i_(m_plan_len(plan), 0, "Failed recordings should not be recorded.");
+
+    cl_assert_(m_plan_scratch(plan, 2, 2), "Scratch that fits the workspace should succeed.");
+    cl_assert_(!m_plan_scratch(plan, 1, 1), "Scratch beyond the workspace should fail.");
+
+    m_del(a);
+    m_del(b);
+    m_del(c);
+    m_plan_del(plan);
+}
+
+void test_data_structures_matrix_plan__replay_matches(void)
+{
+    const size_t sizes[] = {2, 3, 4, 5};
+
+    for (size_t s = 0; s < array_length(sizes); s++) {
+        const size_t n = sizes[s];
+        m_t *F = m_new(n, n);
+        m_t *P = m_new(n, n);
+        m_t *Q = m_new(n, n);
+        m_t *FP = m_new(n, n);
+        m_t *Ft = m_new(n, n);
+        m_t *expected = m_new(n, n);
+        m_plan_t *plan = m_plan_new(2*n*n);
+        m_t *tmp, *Ft_s;
+
+        cl_assert(F && P && Q && FP && Ft && expected && plan);
+
+        /* P = F*P*F^T + Q, the Kalman covariance predict. */
+        tmp = m_plan_scratch(plan, n, n);
+        Ft_s = m_plan_scratch(plan, n, n);
+        cl_assert(tmp && Ft_s);
+        cl_assert_equal_i(m_plan_mult(plan, F, P, tmp), E_OK);
+        cl_assert_equal_i(m_plan_transpose(plan, F, Ft_s), E_OK);
+        cl_assert_equal_i(m_plan_mult(plan, tmp, Ft_s, P), E_OK);
+        cl_assert_equal_i(m_plan_add(plan, P, Q, P), E_OK);
+        cl_assert_equal_i(m_plan_len(plan), 4);
+
+        fill(F, 0.5);
+        fill(P, 1.0);
+        fill(Q, 2.0);
+
+        for (int rep = 0; rep < 3; rep++) {
+            cl_assert_equal_i(m_mult(F, P, FP), E_OK);
+            cl_assert_equal_i(m_transpose(F, Ft), E_OK);
+            cl_assert_equal_i(m_mult(FP, Ft, expected), E_OK);
+            cl_assert_equal_i(m_add(expected, Q, expected), E_OK);
+
+            cl_assert_equal_i(m_plan_run(plan), E_OK);
+            cl_assert_(m_equal(P, expected), "Replay should match the unplanned operations.");
+        }
+
+        m_del(F);
+        m_del(P);
+        m_del(Q);
+        m_del(FP);
+        m_del(Ft);
+        m_del(expected);
+        m_plan_del(plan);
+    }
+}
+
+void test_data_structures_matrix_plan__mixed_order(void)
+{
+    m_plan_t *plan = m_plan_new(0);
+    m_t *a = m_new_ordered(3, 4, M_ROW_MAJOR);
+    m_t *b = m_new_ordered(3, 4, M_COL_MAJOR);
+    m_t *sum = m_new_ordered(3, 4, M_COL_MAJOR);
+    m_t *neg = m_new_ordered(3, 4, M_COL_MAJOR);
+    m_t *at_col = m_new_ordered(4, 3, M_COL_MAJOR);
+    m_t *at_row = m_new_ordered(4, 3, M_ROW_MAJOR);
+    cl_assert(plan && a && b && sum && neg && at_col && at_row);
+
+    cl_assert_equal_i(m_plan_add(plan, a, b, sum), E_OK);
+    cl_assert_equal_i(m_plan_negate(plan, a, neg), E_OK);
+    cl_assert_equal_i(m_plan_transpose(plan, a, at_col), E_OK);
+    cl_assert_equal_i(m_plan_transpose(plan, a, at_row), E_OK);
+
+    fill(a, 0.5);
+    fill(b, -7.0);
+    cl_assert_equal_i(m_plan_run(plan), E_OK);
+
+    for (size_t m = 0; m < 3; m++)
+        for (size_t n = 0; n < 4; n++) {
+            cl_assert_(m_get(sum, m, n) == m_get(a, m, n) + m_get(b, m, n), "Mixed order add is wrong.");
+            cl_assert_(m_get(neg, m, n) == -m_get(a, m, n), "Mixed order negate is wrong.");
+            cl_assert_(m_get(at_col, n, m) == m_get(a, m, n), "Transpose into col-major is wrong.");
+            cl_assert_(m_get(at_row, n, m) == m_get(a, m, n), "Transpose into row-major is wrong.");
+        }
+
+    m_del(a);
+    m_del(b);
+    m_del(sum);
+    m_del(neg);
+    m_del(at_col);
+    m_del(at_row);
+    m_plan_del(plan);
+}
+
+void test_data_structures_matrix_plan__mixed_order_aliasing(void)
+{
+    m_plan_t *plan = m_plan_new(0);
+    m_t *s = m_new_ordered(3, 3, M_ROW_MAJOR);
+    m_t *t = m_new_ordered(3, 3, M_ROW_MAJOR);
+    m_t s_col;
+    cl_assert(plan && s && t);
+    cl_assert_equal_i(m_init_view(&s_col, 3, 3, M_COL_MAJOR, s->data), E_OK);
+
+    /* s_col is s's storage read the other way, so these would overwrite
+       entries the same step still has to read.
+    */
+    cl_assert_equal_i_(m_plan_add(plan, s, t, &s_col), E_VAL, "Adding into lhs's storage in the other order should fail.");
+    cl_assert_equal_i_(m_plan_add(plan, t, s, &s_col), E_VAL, "Adding into rhs's storage in the other order should fail.");
+    cl_assert_equal_i_(m_plan_negate(plan, s, &s_col), E_VAL, "Negating into storage in the other order should fail.");
+    cl_assert_equal_i_(m_plan_transpose(plan, s, &s_col), E_VAL, "Transposing into its own storage should fail.");
+    cl_assert_equal_i(m_plan_len(plan), 0);
+
+    /* The same storage in the same order is plain elementwise in place. */
+    cl_assert_equal_i(m_plan_add(plan, s, t, s), E_OK);
+    cl_assert_equal_i(m_plan_negate(plan, &s_col, &s_col), E_OK);
+
+    fill(s, 1.0);
+    fill(t, 2.0);
+    cl_assert_equal_i(m_plan_run(plan), E_OK);
+    for (size_t m = 0; m < 3; m++)
+        for (size_t n = 0; n < 3; n++)
+            cl_assert(m_get(s, m, n) == -(3.0 + 2.0*(m*3 + n)));
+
+    m_del(s);
+    m_del(t);
+    m_plan_del(plan);
+}
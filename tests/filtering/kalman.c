@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/matrix.h"
+#include "data_structures/vector.h"
+#include "filtering/kalman.h"
+#include "integrators/lti.h"
+
+void test_filtering_kalman__initialize(void) {
+    global_test_counter++;
+}
+
+void test_filtering_kalman__cleanup(void)
+{
+}
+
+/* A damped oscillator driven by u with noise on the velocity. */
+static m_data_t a[] = {0, 1, 0,
+                       -2, -0.3, 0.5,
+                       0, 0, -1};
+static m_data_t b[] = {0, 1, 0.25};
+static m_data_t qc[] = {0.01, 0, 0,
+                        0, 0.5, 0.1,
+                        0, 0.1, 0.2};
+
+void test_filtering_kalman__predict(void)
+{
+    const m_order_t orders[] = {M_ROW_MAJOR, M_COL_MAJOR};
+    m_t A, B, Qc;
+    lti_discrete_t *disc;
+    lti_cache_t *cache = lti_cache_new(3, 1, true, 1);
+    cl_assert(cache);
+
+    m_init_view(&A, 3, 3, M_ROW_MAJOR, a);
+    m_init_view(&B, 3, 1, M_ROW_MAJOR, b);
+    m_init_view(&Qc, 3, 3, M_ROW_MAJOR, qc);
+    cl_assert_equal_i(lti_cache_get(cache, &A, &B, &Qc, 0.05f, &disc), E_OK);
+
+    for (size_t o = 0; o < array_length(orders); o++) {
+        m_t *P = m_new_ordered(3, 3, orders[o]);
+        m_t *Phi_t = m_new(3, 3), *PPhi_t = m_new(3, 3), *ref = m_new(3, 3), *ref_P = m_new(3, 3);
+        v_t *x = v_new(3), *u = v_new_from_value(-1.5, 1);
+        cl_assert(P && Phi_t && PPhi_t && ref && ref_P && x && u);
+
+        for (size_t m = 0; m < 3; m++) {
+            x->data[m] = 1.0 - 0.5*m;
+            for (size_t n = 0; n < 3; n++)
+                m_set(P, m, n, (m == n ? 2.0 : 0.3) + 0.1*(m + n));
+        }
+
+        /* ref_P = Phi P Phi^T + Qd with plain m_mults. */
+        cl_assert_equal_i(m_transpose(disc->Phi, Phi_t), E_OK);
+        cl_assert_equal_i(m_mult(P, Phi_t, PPhi_t), E_OK);
+        cl_assert_equal_i(m_mult(disc->Phi, PPhi_t, ref), E_OK);
+        cl_assert_equal_i(m_add(ref, disc->Qd, ref_P), E_OK);
+
+        v_data_t ref_x[3];
+        for (size_t m = 0; m < 3; m++) {
+            ref_x[m] = m_get(disc->Gamma, m, 0)*u->data[0];
+            for (size_t n = 0; n < 3; n++)
+                ref_x[m] += m_get(disc->Phi, m, n)*x->data[n];
+        }
+
+        cl_assert_equal_i(kalman_predict(disc, x, u, P), E_OK);
+        cl_assert_(P->order == orders[o], "kalman_predict shouldn't change P's order.");
+        for (size_t m = 0; m < 3; m++) {
+            cl_assert_(fabs(x->data[m] - ref_x[m]) < 1e-14, "Predicted state is wrong.");
+            for (size_t n = 0; n < 3; n++)
+                cl_assert_(fabs(m_get(P, m, n) - m_get(ref_P, m, n)) < 1e-14, "Predicted covariance is wrong.");
+        }
+
+        m_del(P); m_del(Phi_t); m_del(PPhi_t); m_del(ref); m_del(ref_P);
+        v_del(x); v_del(u);
+    }
+
+    lti_cache_del(cache);
+}
+
+void test_filtering_kalman__predict_needs_noise(void)
+{
+    lti_discrete_t *disc = lti_discrete_new(2, 0, false);
+    v_t *x = v_new_zeros(2);
+    m_t *P = m_new(2, 2), *P3 = m_new(3, 3);
+    cl_assert(disc && x && P && P3);
+
+    cl_assert_equal_i_(kalman_predict(disc, x, NULL, P), E_VAL, "A disc without Qd can't predict P.");
+    lti_discrete_del(disc);
+
+    disc = lti_discrete_new(2, 0, true);
+    cl_assert(disc);
+    cl_assert_equal_i_(kalman_predict(disc, x, NULL, P3), E_VAL, "P must match the state size.");
+
+    lti_discrete_del(disc);
+    v_del(x);
+    m_del(P); m_del(P3);
+}
+
+void test_filtering_kalman__failed_predict_leaves_state(void)
+{
+    m_t A, B, Qc;
+    lti_discrete_t *disc;
+    lti_cache_t *cache = lti_cache_new(3, 1, true, 1);
+    v_t *x = v_new(3), *u = v_new_from_value(1.0, 1);
+    m_t *P = m_new(3, 3);
+    cl_assert(cache && x && u && P);
+
+    m_init_view(&A, 3, 3, M_ROW_MAJOR, a);
+    m_init_view(&B, 3, 1, M_ROW_MAJOR, b);
+    m_init_view(&Qc, 3, 3, M_ROW_MAJOR, qc);
+    cl_assert_equal_i(lti_cache_get(cache, &A, &B, &Qc, 0.05f, &disc), E_OK);
+
+    for (size_t m = 0; m < 3; m++) {
+        x->data[m] = 1.0 + m;
+        for (size_t n = 0; n < 3; n++)
+            m_set(P, m, n, m == n ? 1.0 : 0.0);
+    }
+
+    /* lti_step fails: disc has a Gamma but there's no control. */
+    cl_assert_equal_i(kalman_predict(disc, x, NULL, P), E_VAL);
+    for (size_t m = 0; m < 3; m++)
+        cl_assert_(x->data[m] == 1.0 + m, "A failed predict should leave x alone.");
+
+    /* The state step succeeds but the covariance product can't be done in
+       place, so x must not have been moved either.
+    */
+    m_t *work = disc->_work;
+    m_set_all(work, 0.25);
+    cl_assert_equal_i(kalman_predict(disc, x, u, work), E_VAL);
+    for (size_t m = 0; m < 3; m++) {
+        cl_assert_(x->data[m] == 1.0 + m, "A failed covariance update should leave x alone.");
+        for (size_t n = 0; n < 3; n++)
+            cl_assert_(m_get(work, m, n) == 0.25, "A failed covariance update should leave P alone.");
+    }
+
+    cl_assert_equal_i(kalman_predict(disc, x, u, P), E_OK);
+    cl_assert_(x->data[0] != 1.0, "A good predict should move x.");
+
+    v_del(x); v_del(u);
+    m_del(P);
+    lti_cache_del(cache);
+}
@@ -0,0 +1,173 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/vector.h"
+#include "filtering/particle.h"
+#include "parallel/thread_pool.h"
+
+void test_filtering_particle__initialize(void) {
+    global_test_counter++;
+}
+
+void test_filtering_particle__cleanup(void)
+{
+    parallel_set_threads(0);
+}
+
+/* A 2D random walk: x += dt*N(0, 1) on both components. */
+static error_t random_walk(void *ctx, v_data_t *states, size_t stride, size_t begin, size_t end,
+                           float dt, v_t *cur_ctrl, particle_rng_t *rng)
+{
+    (void)ctx; (void)cur_ctrl;
+    for (size_t d = 0; d < 2; d++)
+        for (size_t i = begin; i < end; i++)
+            states[d*stride + i] += dt*particle_rng_normal(rng);
+    return E_OK;
+}
+
+static const size_t dims[] = {0, 1};
+static const v_data_t sigma[] = {0.5, 2.0};
+static particle_gaussian_t gaussian = { .dims = dims, .sigma = sigma, .n_meas = 2 };
+
+void test_filtering_particle__gaussian_posterior(void)
+{
+    /* Prior N(0, 1) per component, measurement noise sigma: the posterior
+       mean is z/(1 + sigma^2).
+    */
+    const size_t n = 50000;
+    particle_filter_t *pf = particle_filter_new(n, 2, random_walk, particle_loglik_gaussian, &gaussian, 7);
+    v_t *zero = v_new_zeros(2), *one = v_new_ones(2), *z = v_new(2), *mean = v_new(2);
+    cl_assert(pf && zero && one && z && mean);
+
+    cl_assert_equal_i(particle_filter_init_gaussian(pf, zero, one), E_OK);
+    cl_assert_(fabs(particle_filter_ess(pf) - n) < 1e-6*n, "Uniform weights should give an ESS of n.");
+
+    z->data[0] = 1.0; z->data[1] = -2.0;
+    cl_assert_equal_i(particle_filter_update(pf, z), E_OK);
+
+    v_data_t total = 0.0;
+    for (size_t i = 0; i < n; i++)
+        total += exp(pf->log_weights[i]);
+    cl_assert_(fabs(total - 1.0) < 1e-12, "Weights should be normalized.");
+    cl_assert_(particle_filter_ess(pf) < n, "An informative measurement should reduce the ESS.");
+
+    cl_assert_equal_i(particle_filter_mean(pf, mean), E_OK);
+    cl_assert_(fabs(mean->data[0] - 1.0/1.25) < 0.02, "Posterior mean of component 0 is wrong.");
+    cl_assert_(fabs(mean->data[1] + 2.0/5.0) < 0.02, "Posterior mean of component 1 is wrong.");
+
+    /* A rejected update must leave the weights, and so the mean, alone. */
+    v_data_t *saved = malloc(n*sizeof *saved);
+    v_t *short_z = v_new(1), *mean_after = v_new(2);
+    cl_assert(saved && short_z && mean_after);
+    memcpy(saved, pf->log_weights, n*sizeof *saved);
+
+    cl_assert_equal_i_(particle_filter_update(pf, short_z), E_VAL, "Measurement length should be checked.");
+    cl_assert_(!memcmp(saved, pf->log_weights, n*sizeof *saved), "A rejected update shouldn't change the weights.");
+    cl_assert_equal_i(particle_filter_mean(pf, mean_after), E_OK);
+    cl_assert_(mean_after->data[0] == mean->data[0] && mean_after->data[1] == mean->data[1],
+               "A rejected update shouldn't move the mean.");
+
+    free(saved);
+    v_del(short_z);
+    v_del(mean_after);
+
+    particle_filter_del(pf);
+    v_del(zero); v_del(one); v_del(z); v_del(mean);
+}
+
+void test_filtering_particle__resample(void)
+{
+    const particle_resample_t methods[] = {PARTICLE_SYSTEMATIC, PARTICLE_STRATIFIED};
+    const size_t n = 10000;
+    v_t *zero = v_new_zeros(2), *one = v_new_ones(2), *z = v_new_zeros(2), *before = v_new(2), *after = v_new(2);
+    cl_assert(zero && one && z && before && after);
+
+    for (size_t m = 0; m < 2; m++) {
+        particle_filter_t *pf = particle_filter_new(n, 2, random_walk, particle_loglik_gaussian, &gaussian, 11);
+        cl_assert(pf);
+        cl_assert_equal_i(particle_filter_init_gaussian(pf, zero, one), E_OK);
+        cl_assert_equal_i(particle_filter_update(pf, z), E_OK);
+        cl_assert_equal_i(particle_filter_mean(pf, before), E_OK);
+
+        v_data_t *states = pf->states;
+        cl_assert_equal_i(particle_filter_resample(pf, methods[m]), E_OK);
+        cl_assert_(pf->states != states, "Resampling should leave the particles in the other state buffer.");
+        cl_assert_(fabs(particle_filter_ess(pf) - n) < 1e-6*n, "Weights should be uniform after resampling.");
+
+        cl_assert_equal_i(particle_filter_mean(pf, after), E_OK);
+        cl_assert_(fabs(after->data[0] - before->data[0]) < 0.02 && fabs(after->data[1] - before->data[1]) < 0.02,
+                   "Resampling shouldn't move the mean much.");
+
+        particle_filter_del(pf);
+    }
+
+    v_del(zero); v_del(one); v_del(z); v_del(before); v_del(after);
+}
+
+void test_filtering_particle__thread_independent(void)
+{
+    /* Several chunks, so the pool actually has something to share. */
+    const size_t n = 3*PARTICLE_CHUNK + 17;
+    const size_t threads[] = {1, 4};
+    v_data_t *results[2];
+    v_t *zero = v_new_zeros(2), *one = v_new_ones(2), *z = v_new(2);
+    cl_assert(zero && one && z);
+    z->data[0] = 0.3; z->data[1] = 0.1;
+
+    for (size_t t = 0; t < 2; t++) {
+        cl_assert_equal_i(parallel_set_threads(threads[t]), E_OK);
+        particle_filter_t *pf = particle_filter_new(n, 2, random_walk, particle_loglik_gaussian, &gaussian, 3);
+        cl_assert(pf);
+        cl_assert_equal_i(particle_filter_init_gaussian(pf, zero, one), E_OK);
+        for (size_t step = 0; step < 5; step++) {
+            cl_assert_equal_i(particle_filter_predict(pf, 0.1f, NULL), E_OK);
+            cl_assert_equal_i(particle_filter_update(pf, z), E_OK);
+            cl_assert_equal_i(particle_filter_resample(pf, PARTICLE_SYSTEMATIC), E_OK);
+        }
+
+        results[t] = malloc(2*n*sizeof *results[t]);
+        cl_assert(results[t]);
+        memcpy(results[t], pf->states, 2*n*sizeof *results[t]);
+        particle_filter_del(pf);
+    }
+
+    cl_assert_(!memcmp(results[0], results[1], 2*n*sizeof *results[0]), "Results shouldn't depend on thread count.");
+
+    free(results[0]);
+    free(results[1]);
+    v_del(zero); v_del(one); v_del(z);
+}
+
+/* Fails on every chunk but the first. */
+static error_t first_chunk_only(void *ctx, const v_data_t *states, size_t stride,
+                                size_t begin, size_t end, v_t *meas, v_data_t *log_lik)
+{
+    if (begin > 0) return E_ERR;
+    return particle_loglik_gaussian(ctx, states, stride, begin, end, meas, log_lik);
+}
+
+void test_filtering_particle__partial_failure(void)
+{
+    const size_t n = 2*PARTICLE_CHUNK;
+    particle_filter_t *pf = particle_filter_new(n, 2, random_walk, first_chunk_only, &gaussian, 5);
+    v_t *zero = v_new_zeros(2), *one = v_new_ones(2);
+    v_data_t *saved = malloc(n*sizeof *saved);
+    cl_assert(pf && zero && one && saved);
+
+    cl_assert_equal_i(particle_filter_init_gaussian(pf, zero, one), E_OK);
+    memcpy(saved, pf->log_weights, n*sizeof *saved);
+
+    cl_assert_equal_i_(particle_filter_update(pf, zero), E_ERR, "A failing chunk should fail the update.");
+    cl_assert_(!memcmp(saved, pf->log_weights, n*sizeof *saved), "Chunks that succeeded shouldn't be applied alone.");
+
+    free(saved);
+    particle_filter_del(pf);
+    v_del(zero); v_del(one);
+}
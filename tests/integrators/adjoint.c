@@ -0,0 +1,130 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/vector.h"
+#include "integrators/integrator.h"
+#include "integrators/adjoint.h"
+
+void test_integrators_adjoint__initialize(void) {
+    global_test_counter++;
+}
+
+void test_integrators_adjoint__cleanup(void)
+{
+}
+
+/* A damped pendulum with the control as parameters:
+   x0' = x1, x1' = -p0 sin(x0) - p1 x1
+*/
+static error_t pendulum(v_t *st, v_t *p, v_t *rate)
+{
+    rate->data[0] = st->data[1];
+    rate->data[1] = -p->data[0]*sin(st->data[0]) - p->data[1]*st->data[1];
+    return E_OK;
+}
+
+static error_t pendulum_vjp(v_t *st, v_t *p, v_t *lambda, v_t *st_bar, v_t *p_bar)
+{
+    st_bar->data[0] = -p->data[0]*cos(st->data[0])*lambda->data[1];
+    st_bar->data[1] = lambda->data[0] - p->data[1]*lambda->data[1];
+    p_bar->data[0] = -sin(st->data[0])*lambda->data[1];
+    p_bar->data[1] = -st->data[1]*lambda->data[1];
+    return E_OK;
+}
+
+/* J = |x|^2 / 2 */
+static error_t half_norm_grad(v_t *final_st, v_t *grad)
+{
+    grad->data[0] = final_st->data[0];
+    grad->data[1] = final_st->data[1];
+    return E_OK;
+}
+
+static const float dt = 0.01f;
+static const size_t n_steps = 300;
+
+static double run_cost(v_t *st0, v_t *p)
+{
+    v_t *a = v_new(2), *b = v_new(2);
+    a->data[0] = st0->data[0];
+    a->data[1] = st0->data[1];
+    for (size_t i = 0; i < n_steps; i++) {
+        integrator_rk4(pendulum, dt, a, p, b);
+        v_t *tmp = a; a = b; b = tmp;
+    }
+    double J = 0.5*(a->data[0]*a->data[0] + a->data[1]*a->data[1]);
+    v_del(a);
+    v_del(b);
+    return J;
+}
+
+void test_integrators_adjoint__matches_finite_differences(void)
+{
+    v_t *st0 = v_new(2), *p = v_new(2), *st_grad = v_new(2), *p_grad = v_new(2), *fin = v_new(2);
+    integrator_adjoint_t *adj = integrator_adjoint_new(pendulum, pendulum_vjp, 2, 2, 4);
+    cl_assert(st0 && p && st_grad && p_grad && fin && adj);
+
+    st0->data[0] = 1.0; st0->data[1] = -0.5;
+    p->data[0] = 9.81;  p->data[1] = 0.3;
+
+    cl_assert_equal_i(integrator_adjoint_rk4(adj, half_norm_grad, dt, n_steps, st0, p, fin, st_grad, p_grad), E_OK);
+    cl_assert_(fabs(0.5*(fin->data[0]*fin->data[0] + fin->data[1]*fin->data[1]) - run_cost(st0, p)) < 1e-12,
+               "Final state should match plain RK4.");
+
+    const double eps = 1e-6;
+    for (size_t i = 0; i < 2; i++) {
+        const double x = st0->data[i], q = p->data[i];
+
+        st0->data[i] = x + eps; double jp = run_cost(st0, p);
+        st0->data[i] = x - eps; double jm = run_cost(st0, p);
+        st0->data[i] = x;
+        cl_assert_(fabs((jp - jm)/(2*eps) - st_grad->data[i]) < 1e-6, "State gradient doesn't match finite differences.");
+
+        p->data[i] = q + eps; jp = run_cost(st0, p);
+        p->data[i] = q - eps; jm = run_cost(st0, p);
+        p->data[i] = q;
+        cl_assert_(fabs((jp - jm)/(2*eps) - p_grad->data[i]) < 1e-6, "Parameter gradient doesn't match finite differences.");
+    }
+
+    integrator_adjoint_del(adj);
+    v_del(st0); v_del(p); v_del(st_grad); v_del(p_grad); v_del(fin);
+}
+
+void test_integrators_adjoint__checkpoint_tradeoff(void)
+{
+    const size_t checkpoints[] = {0, 1, 3, 9, n_steps};
+    v_t *st0 = v_new(2), *p = v_new(2), *st_grad = v_new(2), *p_grad = v_new(2);
+    double ref[4] = {0};
+    size_t prev_steps = 0;
+    cl_assert(st0 && p && st_grad && p_grad);
+
+    st0->data[0] = 0.2; st0->data[1] = 1.5;
+    p->data[0] = 4.0;   p->data[1] = 0.1;
+
+    for (size_t c = 0; c < array_length(checkpoints); c++) {
+        integrator_adjoint_t *adj = integrator_adjoint_new(pendulum, pendulum_vjp, 2, 2, checkpoints[c]);
+        cl_assert(adj);
+        cl_assert_equal_i(integrator_adjoint_rk4(adj, half_norm_grad, dt, n_steps, st0, p, NULL, st_grad, p_grad), E_OK);
+
+        double got[4] = {st_grad->data[0], st_grad->data[1], p_grad->data[0], p_grad->data[1]};
+        for (size_t i = 0; i < 4; i++) {
+            if (c == 0) ref[i] = got[i];
+            cl_assert_(got[i] == ref[i], "Gradients shouldn't depend on the number of checkpoints.");
+        }
+
+        if (c > 0) cl_assert_(adj->n_forward_steps < prev_steps, "More checkpoints should mean less recomputation.");
+        prev_steps = adj->n_forward_steps;
+        integrator_adjoint_del(adj);
+    }
+
+    /* A checkpoint for every step means nothing is recomputed. */
+    cl_assert_equal_i(prev_steps, n_steps);
+
+    v_del(st0); v_del(p); v_del(st_grad); v_del(p_grad);
+}
@@ -0,0 +1,195 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/vector.h"
+#include "integrators/events.h"
+
+void test_integrators_events__initialize(void) {
+    global_test_counter++;
+}
+
+void test_integrators_events__cleanup(void)
+{
+}
+
+/* A ball thrown up at 10 m/s from 5 m under 10 m/s^2 of gravity:
+   h(t) = 5 + 10t - 5t^2, so the apex is at t = 1 with h = 10, h = 8 at
+   t = 1 -+ sqrt(0.4) and the ground at t = 1 + sqrt(2).
+*/
+#define T_APEX 1.0
+#define T_UP8 (1.0 - sqrt(0.4))
+#define T_DOWN8 (1.0 + sqrt(0.4))
+#define T_IMPACT (1.0 + sqrt(2.0))
+
+static error_t ball(v_t *st, v_t *ctrl, v_t *rate)
+{
+    (void)ctrl;
+    rate->data[0] = st->data[1];
+    rate->data[1] = -10;
+    return E_OK;
+}
+
+static error_t height(v_t *st, v_t *ctrl, v_data_t *val)
+{
+    (void)ctrl;
+    *val = st->data[0];
+    return E_OK;
+}
+
+static error_t height_8(v_t *st, v_t *ctrl, v_data_t *val)
+{
+    (void)ctrl;
+    *val = st->data[0] - 8;
+    return E_OK;
+}
+
+/* Touches 0 at the apex without crossing. */
+static error_t height_10(v_t *st, v_t *ctrl, v_data_t *val)
+{
+    (void)ctrl;
+    *val = st->data[0] - 10;
+    return E_OK;
+}
+
+static error_t speed(v_t *st, v_t *ctrl, v_data_t *val)
+{
+    (void)ctrl;
+    *val = st->data[1];
+    return E_OK;
+}
+
+#define MAX_HITS 4
+
+typedef struct hits {
+    size_t n;
+    double t[MAX_HITS];
+} hits_t;
+
+/* Throws the ball and records when each event fired until a terminal one
+   stops it.  Returns the time it stopped at and leaves the state in st.
+*/
+static double throw_ball(integrator_event_t *events, size_t n_events, hits_t *hits, v_data_t st[2])
+{
+    v_data_t next_data[2];
+    v_t cur = { .len = 2, .data = st };
+    v_t next = { .len = 2, .data = next_data };
+    integrator_events_t *ev = integrator_events_new(events, n_events, 2);
+    double t = 0;
+    bool done = false;
+    cl_assert(ev);
+
+    st[0] = 5;
+    st[1] = 10;
+    for (size_t i = 0; i < n_events; i++) hits[i].n = 0;
+
+    /* 0.3 never lands a step end on any of the crossings. */
+    for (size_t step = 0; step < 100 && !done; step++) {
+        float dt_taken;
+        cl_assert_equal_i(integrator_events_step(ev, integrator_rk4, ball, 0.3f, &cur, NULL, &next, &dt_taken, &done), E_OK);
+        if (!done) cl_assert_(dt_taken == 0.3f, "Only a terminal event should shorten the step.");
+
+        for (size_t i = 0; i < n_events; i++) {
+            if (!events[i].fired) continue;
+            cl_assert(hits[i].n < MAX_HITS);
+            hits[i].t[hits[i].n++] = t + events[i].t;
+        }
+
+        t += dt_taken;
+        st[0] = next_data[0];
+        st[1] = next_data[1];
+    }
+
+    cl_assert_(done, "The ball never hit the ground.");
+    integrator_events_del(ev);
+    return t;
+}
+
+void test_integrators_events__ball(void)
+{
+    integrator_event_t events[] = {
+        { .fn = speed, .direction = EVENT_FALLING, .terminal = false },
+        { .fn = height, .direction = EVENT_ANY, .terminal = true },
+        { .fn = height_10, .direction = EVENT_ANY, .terminal = false },
+    };
+    hits_t hits[array_length(events)];
+    v_data_t st[2];
+
+    const double t = throw_ball(events, array_length(events), hits, st);
+
+    cl_assert_equal_i_(hits[0].n, 1, "The apex should fire once.");
+    cl_assert_(fabs(hits[0].t[0] - T_APEX) < 1e-6, "Apex localized badly.");
+
+    /* The terminal event cuts the step at the ground. */
+    cl_assert_equal_i(hits[1].n, 1);
+    cl_assert_(fabs(hits[1].t[0] - T_IMPACT) < 1e-6, "Impact localized badly.");
+    cl_assert_(fabs(t - T_IMPACT) < 1e-6, "The run should stop at the impact.");
+    cl_assert_(st[0] <= 0 && st[0] > -1e-5, "The state should be just past the ground.");
+    cl_assert_(fabs(st[1] + 10*sqrt(2.0)) < 1e-5, "Impact speed is wrong.");
+
+    cl_assert_equal_i_(hits[2].n, 0, "Touching zero is not a crossing.");
+}
+
+void test_integrators_events__direction(void)
+{
+    integrator_event_t events[] = {
+        { .fn = height_8, .direction = EVENT_RISING, .terminal = false },
+        { .fn = height_8, .direction = EVENT_FALLING, .terminal = false },
+        { .fn = height_8, .direction = EVENT_ANY, .terminal = false },
+        { .fn = height, .direction = EVENT_FALLING, .terminal = true },
+    };
+    hits_t hits[array_length(events)];
+    v_data_t st[2];
+
+    throw_ball(events, array_length(events), hits, st);
+
+    cl_assert_equal_i(hits[0].n, 1);
+    cl_assert_(fabs(hits[0].t[0] - T_UP8) < 1e-6, "Rising crossing localized badly.");
+    cl_assert_equal_i(hits[1].n, 1);
+    cl_assert_(fabs(hits[1].t[0] - T_DOWN8) < 1e-6, "Falling crossing localized badly.");
+    cl_assert_equal_i(hits[2].n, 2);
+    cl_assert_(hits[2].t[0] == hits[0].t[0] && hits[2].t[1] == hits[1].t[0], "EVENT_ANY should see both crossings.");
+}
+
+void test_integrators_events__rising_terminal_ignores_falling(void)
+{
+    /* A rising-only terminal event must not stop the ball on the way down. */
+    integrator_event_t events[] = {
+        { .fn = speed, .direction = EVENT_RISING, .terminal = true },
+        { .fn = height_8, .direction = EVENT_FALLING, .terminal = true },
+    };
+    hits_t hits[array_length(events)];
+    v_data_t st[2];
+
+    const double t = throw_ball(events, array_length(events), hits, st);
+
+    cl_assert_equal_i(hits[0].n, 0);
+    cl_assert_equal_i(hits[1].n, 1);
+    cl_assert_(fabs(t - T_DOWN8) < 1e-6, "The run should stop on the way down through 8 m.");
+}
+
+void test_integrators_events__errors(void)
+{
+    integrator_event_t events[] = {
+        { .fn = height, .direction = EVENT_ANY, .terminal = true },
+    };
+    v_data_t data[2] = { 5, 10 };
+    v_t cur = { .len = 2, .data = data };
+    float dt_taken;
+    bool done;
+    integrator_events_t *ev = integrator_events_new(events, 1, 2);
+    cl_assert(ev);
+
+    cl_assert_(integrator_events_new(NULL, 1, 2) == NULL, "NULL events should fail.");
+    cl_assert_equal_i_(integrator_events_step(ev, integrator_rk4, ball, 0.1f, &cur, NULL, &cur, &dt_taken, &done),
+                       E_VAL, "Stepping in place should fail.");
+    cl_assert_equal_i_(integrator_events_step(NULL, integrator_rk4, ball, 0.1f, &cur, NULL, &cur, &dt_taken, &done),
+                       E_NULLP, "NULL context should fail.");
+
+    integrator_events_del(ev);
+}
@@ -0,0 +1,61 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/vector.h"
+#include "integrators/integrator.h"
+
+void test_integrators_integrator__initialize(void) {
+    global_test_counter++;
+}
+
+void test_integrators_integrator__cleanup(void)
+{
+}
+
+/* Logistic growth y' = y(1 - y), exact y = 1/(1 + (1/y0 - 1)e^-t). */
+static error_t logistic(v_t *st, v_t *ctrl, v_t *rate)
+{
+    (void)ctrl;
+    rate->data[0] = st->data[0]*(1 - st->data[0]);
+    return E_OK;
+}
+
+/* Error at t = 2 from y0 = 0.1 after n steps of 2/n. */
+static double logistic_error(integrator_fn int_fn, size_t n)
+{
+    v_data_t y[2] = { 0.1, 0 };
+    v_t cur = { .len = 1, .data = &y[0] };
+    v_t next = { .len = 1, .data = &y[1] };
+
+    for (size_t i = 0; i < n; i++) {
+        cl_assert_equal_i(int_fn(logistic, 2.0f/n, &cur, NULL, &next), E_OK);
+        cur.data[0] = next.data[0];
+    }
+
+    return fabs(y[0] - 1/(1 + 9*exp(-2.0)));
+}
+
+void test_integrators_integrator__order(void)
+{
+    const struct {
+        integrator_fn fn;
+        double order;
+        size_t n;
+    } cases[] = {
+        { integrator_euler, 1, 64 },
+        { integrator_rk4, 4, 8 },
+    };
+
+    for (size_t c = 0; c < array_length(cases); c++) {
+        const double e1 = logistic_error(cases[c].fn, cases[c].n);
+        const double e2 = logistic_error(cases[c].fn, 2*cases[c].n);
+        const double order = log2(e1/e2);
+        cl_assert_(fabs(order - cases[c].order) < 0.15, "Halving dt should cut the error by 2^order.");
+    }
+}
@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/matrix.h"
+#include "data_structures/vector.h"
+#include "integrators/lti.h"
+
+void test_integrators_lti__initialize(void) {
+    global_test_counter++;
+}
+
+void test_integrators_lti__cleanup(void)
+{
+}
+
+/* A double integrator with white noise acceleration of intensity q. */
+static m_data_t a[] = {0, 1, 0, 0};
+static m_data_t b[] = {0, 1};
+static m_data_t qc[] = {0, 0, 0, 0.5};
+
+void test_integrators_lti__double_integrator(void)
+{
+    const float dt = 0.25f;
+    const double h = dt, q = 0.5;
+    m_t A, B, Qc;
+    lti_discrete_t *disc = lti_discrete_new(2, 1, true);
+    v_t *x = v_new(2), *u = v_new_from_value(2.0, 1), *next = v_new(2);
+    cl_assert(disc && x && u && next);
+
+    m_init_view(&A, 2, 2, M_ROW_MAJOR, a);
+    m_init_view(&B, 2, 1, M_ROW_MAJOR, b);
+    m_init_view(&Qc, 2, 2, M_ROW_MAJOR, qc);
+
+    cl_assert_equal_i(lti_discretize(&A, &B, &Qc, dt, disc), E_OK);
+    cl_assert_(fabs(m_get(disc->Phi, 0, 1) - h) < 1e-15 && m_get(disc->Phi, 1, 0) == 0, "Phi should be [1 dt; 0 1].");
+    cl_assert_(fabs(m_get(disc->Gamma, 0, 0) - h*h/2) < 1e-15 && fabs(m_get(disc->Gamma, 1, 0) - h) < 1e-15,
+               "Gamma should be [dt^2/2; dt].");
+    cl_assert_(fabs(m_get(disc->Qd, 0, 0) - q*h*h*h/3) < 1e-15 && fabs(m_get(disc->Qd, 0, 1) - q*h*h/2) < 1e-15 &&
+               fabs(m_get(disc->Qd, 1, 0) - q*h*h/2) < 1e-15 && fabs(m_get(disc->Qd, 1, 1) - q*h) < 1e-15,
+               "Qd should be q [dt^3/3 dt^2/2; dt^2/2 dt].");
+
+    x->data[0] = 1.0; x->data[1] = -3.0;
+    cl_assert_equal_i(lti_step(disc, x, u, next), E_OK);
+    cl_assert_(fabs(next->data[0] - (1.0 - 3.0*h + h*h)) < 1e-14 && fabs(next->data[1] - (-3.0 + 2.0*h)) < 1e-14,
+               "Step should be exact for a double integrator.");
+
+    cl_assert_equal_i_(lti_discretize(&A, NULL, &Qc, dt, disc), E_VAL, "B must be given for a disc with a Gamma.");
+
+    lti_discrete_del(disc);
+    v_del(x); v_del(u); v_del(next);
+}
+
+void test_integrators_lti__cache(void)
+{
+    m_t A, B, Qc;
+    lti_discrete_t *d1, *d2, *d3;
+    lti_cache_t *cache = lti_cache_new(2, 1, true, 2);
+    cl_assert(cache);
+
+    m_init_view(&A, 2, 2, M_ROW_MAJOR, a);
+    m_init_view(&B, 2, 1, M_ROW_MAJOR, b);
+    m_init_view(&Qc, 2, 2, M_ROW_MAJOR, qc);
+
+    cl_assert_equal_i(lti_cache_get(cache, &A, &B, &Qc, 0.1f, &d1), E_OK);
+    cl_assert_equal_i(lti_cache_get(cache, &A, &B, &Qc, 0.2f, &d2), E_OK);
+    cl_assert_(d1 != d2 && d1->dt == 0.1f && d2->dt == 0.2f, "Different dt should be different entries.");
+
+    cl_assert_equal_i(lti_cache_get(cache, &A, &B, &Qc, 0.1f, &d3), E_OK);
+    cl_assert_(d3 == d1, "Same segment should hit the cache.");
+
+    /* Same values in a different layout are the same segment. */
+    m_t *A_col = m_new_ordered(2, 2, M_COL_MAJOR);
+    cl_assert(A_col);
+    for (size_t m = 0; m < 2; m++)
+        for (size_t n = 0; n < 2; n++)
+            m_set(A_col, m, n, m_get(&A, m, n));
+    cl_assert_equal_i(lti_cache_get(cache, A_col, &B, &Qc, 0.2f, &d3), E_OK);
+    cl_assert_(d3 == d2, "The key should depend on values, not layout.");
+
+    b[1] = 2;
+    cl_assert_equal_i(lti_cache_get(cache, &A, &B, &Qc, 0.1f, &d3), E_OK);
+    cl_assert_(fabs(m_get(d3->Gamma, 1, 0) - 0.2) < 1e-7, "Changing B should be a miss.");
+    b[1] = 1;
+
+    cl_assert_equal_i_(lti_cache_get(cache, &A, NULL, &Qc, 0.1f, &d3), E_VAL, "B is required for this cache.");
+
+    m_del(A_col);
+    lti_cache_del(cache);
+}
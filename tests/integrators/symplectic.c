@@ -0,0 +1,157 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/vector.h"
+#include "integrators/symplectic.h"
+
+void test_integrators_symplectic__initialize(void) {
+    global_test_counter++;
+}
+
+void test_integrators_symplectic__cleanup(void)
+{
+}
+
+static size_t accel_calls;
+static double stiffness = 1.0;
+
+/* Harmonic oscillator q'' = -q, exact solution cos(t) from q=1, v=0. */
+static error_t oscillator(v_t *pos, v_t *ctrl, v_t *accel)
+{
+    (void)ctrl;
+    accel_calls++;
+    accel->data[0] = -stiffness*pos->data[0];
+    return E_OK;
+}
+
+/* Kepler problem with mu = 1. */
+static error_t kepler(v_t *pos, v_t *ctrl, v_t *accel)
+{
+    (void)ctrl;
+    accel_calls++;
+    const double r = hypot(pos->data[0], pos->data[1]);
+    const double k = -1.0/(r*r*r);
+    accel->data[0] = k*pos->data[0];
+    accel->data[1] = k*pos->data[1];
+    return E_OK;
+}
+
+static double kepler_energy(v_t *pos, v_t *vel)
+{
+    return 0.5*(vel->data[0]*vel->data[0] + vel->data[1]*vel->data[1]) - 1.0/hypot(pos->data[0], pos->data[1]);
+}
+
+/* Position error at t = 2 for n steps of 2/n. */
+static double oscillator_error(split_integrator_fn int_fn, size_t n)
+{
+    v_data_t q = 1, v = 0;
+    v_t pos = { .len = 1, .data = &q };
+    v_t vel = { .len = 1, .data = &v };
+
+    for (size_t i = 0; i < n; i++)
+        cl_assert_equal_i(int_fn(oscillator, 2.0f/n, &pos, &vel, NULL), E_OK);
+
+    return fabs(q - cos(2.0));
+}
+
+void test_integrators_symplectic__order(void)
+{
+    const struct {
+        split_integrator_fn fn;
+        double order;
+        size_t n;
+    } cases[] = {
+        { integrator_velocity_verlet, 2, 64 },
+        { integrator_yoshida4, 4, 16 },
+        { integrator_suzuki4, 4, 8 },
+        { integrator_yoshida6, 6, 8 },
+    };
+
+    for (size_t c = 0; c < array_length(cases); c++) {
+        const double e1 = oscillator_error(cases[c].fn, cases[c].n);
+        const double e2 = oscillator_error(cases[c].fn, 2*cases[c].n);
+        const double order = log2(e1/e2);
+        cl_assert_(fabs(order - cases[c].order) < 0.25, "Halving dt should cut the error by 2^order.");
+    }
+}
+
+void test_integrators_symplectic__verlet_reuses_accel(void)
+{
+    v_data_t q1 = 1, v1 = 0, q2 = 1, v2 = 0;
+    v_t pos1 = { .len = 1, .data = &q1 }, vel1 = { .len = 1, .data = &v1 };
+    v_t pos2 = { .len = 1, .data = &q2 }, vel2 = { .len = 1, .data = &v2 };
+    integrator_verlet_t *v = integrator_verlet_new(1, 0);
+    cl_assert(v);
+
+    accel_calls = 0;
+    for (size_t i = 0; i < 100; i++)
+        cl_assert_equal_i(integrator_velocity_verlet(oscillator, 0.01f, &pos1, &vel1, NULL), E_OK);
+    cl_assert_equal_i(accel_calls, 200);
+
+    accel_calls = 0;
+    for (size_t i = 0; i < 100; i++)
+        cl_assert_equal_i(integrator_verlet_step(v, oscillator, 0.01f, &pos2, &vel2, NULL), E_OK);
+    cl_assert_equal_i_(accel_calls, 101, "Only the first step should need two accel_fn calls.");
+    cl_assert_(memcmp(&q1, &q2, sizeof(q1)) == 0 && memcmp(&v1, &v2, sizeof(v1)) == 0,
+               "Reusing the acceleration should not change the result.");
+
+    /* Moving the state between steps drops the kept acceleration. */
+    q1 = q2 = 0.5;
+    accel_calls = 0;
+    cl_assert_equal_i(integrator_velocity_verlet(oscillator, 0.01f, &pos1, &vel1, NULL), E_OK);
+    cl_assert_equal_i(integrator_verlet_step(v, oscillator, 0.01f, &pos2, &vel2, NULL), E_OK);
+    cl_assert_equal_i(accel_calls, 4);
+    cl_assert_(q1 == q2 && v1 == v2, "An edited state should be re-evaluated.");
+
+    /* A change the stepper can't see needs a reset. */
+    stiffness = 4.0;
+    accel_calls = 0;
+    cl_assert_equal_i(integrator_velocity_verlet(oscillator, 0.01f, &pos1, &vel1, NULL), E_OK);
+    cl_assert_equal_i(integrator_verlet_reset(v), E_OK);
+    cl_assert_equal_i(integrator_verlet_step(v, oscillator, 0.01f, &pos2, &vel2, NULL), E_OK);
+    stiffness = 1.0;
+    cl_assert_equal_i(accel_calls, 4);
+    cl_assert_(q1 == q2 && v1 == v2, "A reset stepper should re-evaluate.");
+    cl_assert_equal_i(integrator_verlet_reset(NULL), E_NULLP);
+
+    v_data_t u = 1;
+    v_t ctrl = { .len = 1, .data = &u };
+    cl_assert_equal_i_(integrator_verlet_step(v, oscillator, 0.01f, &pos2, &vel2, &ctrl), E_VAL, "Unexpected control should fail.");
+    cl_assert_equal_i_(integrator_verlet_step(NULL, oscillator, 0.01f, &pos2, &vel2, NULL), E_NULLP, "NULL stepper should fail.");
+
+    integrator_verlet_del(v);
+}
+
+/* 200 orbits of an e = 0.5 Kepler orbit, 500 steps per orbit. */
+void test_integrators_symplectic__kepler_energy_bounded(void)
+{
+    const double e = 0.5, period = 2*M_PI;
+    const size_t steps = 500, orbits = 200;
+    const float dt = period/steps;
+    const split_integrator_fn fns[] = { integrator_velocity_verlet, integrator_yoshida4 };
+
+    for (size_t f = 0; f < array_length(fns); f++) {
+        v_data_t q[2] = { 1 - e, 0 }, v[2] = { 0, sqrt((1 + e)/(1 - e)) };
+        v_t pos = { .len = 2, .data = q }, vel = { .len = 2, .data = v };
+        const double e0 = kepler_energy(&pos, &vel);
+        double first = 0, last = 0;
+
+        for (size_t o = 0; o < orbits; o++)
+            for (size_t i = 0; i < steps; i++) {
+                cl_assert_equal_i(fns[f](kepler, dt, &pos, &vel, NULL), E_OK);
+                const double err = fabs(kepler_energy(&pos, &vel) - e0);
+                if (o < 10) first = fmax(first, err);
+                if (o >= orbits - 10) last = fmax(last, err);
+            }
+
+        cl_assert_(last < 1e-3, "Energy error should stay small.");
+        cl_assert_(last < 1.5*first, "Energy error should not drift over many orbits.");
+    }
+}
@@ -0,0 +1,160 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/matrix.h"
+#include "data_structures/matrix_batch.h"
+#include "linear_algebra/batch.h"
+#include "linear_algebra/decompositions.h"
+
+void test_linear_algebra_batch__initialize(void) {
+    global_test_counter++;
+}
+
+void test_linear_algebra_batch__cleanup(void)
+{
+}
+
+#define N 6
+#define COUNT 9
+/* The lane that gets an indefinite matrix in the poison test. */
+#define BAD_LANE 3
+
+/* A = M M^T + N I, different for every lane. */
+static void fill_spd(m_t *A, size_t lane)
+{
+    for (size_t m = 0; m < N; m++)
+        for (size_t n = 0; n <= m; n++) {
+            m_data_t s = m == n ? N : 0.0;
+            for (size_t k = 0; k < N; k++)
+                s += sin(1.0 + lane*7.0 + m*N + k)*sin(1.0 + lane*7.0 + n*N + k);
+            m_set(A, m, n, s);
+            m_set(A, n, m, s);
+        }
+}
+
+static void fill_rhs(m_t *B, size_t lane)
+{
+    for (size_t m = 0; m < B->rows; m++)
+        for (size_t n = 0; n < B->cols; n++)
+            m_set(B, m, n, cos(lane + 3.0*m + n));
+}
+
+/* Largest entrywise difference between two matricies of the same size. */
+static m_data_t max_diff(m_t *a, m_t *b)
+{
+    m_data_t d = 0.0;
+    for (size_t m = 0; m < a->rows; m++)
+        for (size_t n = 0; n < a->cols; n++)
+            d = fmax(d, fabs(m_get(a, m, n) - m_get(b, m, n)));
+    return d;
+}
+
+void test_linear_algebra_batch__cholesky_matches(void)
+{
+    m_batch_t *A = m_batch_new(N, N, COUNT), *L = m_batch_new(N, N, COUNT);
+    m_t *a = m_new(N, N), *ref = m_new(N, N), *got = m_new(N, N);
+    cl_assert(A && L && a && ref && got);
+
+    for (size_t b = 0; b < COUNT; b++) {
+        fill_spd(a, b);
+        cl_assert_equal_i(m_batch_load(A, b, a), E_OK);
+    }
+
+    cl_assert_equal_i(la_batch_cholesky(A, L), E_OK);
+    for (size_t b = 0; b < COUNT; b++) {
+        fill_spd(a, b);
+        cl_assert_equal_i(la_decompositions_cholesky(a, ref), E_OK);
+        cl_assert_equal_i(m_batch_store(L, b, got), E_OK);
+        cl_assert_(max_diff(got, ref) < 1e-13, "Batch lane doesn't match la_decompositions_cholesky.");
+    }
+
+    /* L == A overwrites A with the same factors. */
+    cl_assert_equal_i(la_batch_cholesky(A, A), E_OK);
+    for (size_t b = 0; b < COUNT; b++) {
+        cl_assert_equal_i(m_batch_store(L, b, ref), E_OK);
+        cl_assert_equal_i(m_batch_store(A, b, got), E_OK);
+        cl_assert_(max_diff(got, ref) == 0.0, "In place Cholesky should match out of place.");
+    }
+
+    m_batch_del(A); m_batch_del(L);
+    m_del(a); m_del(ref); m_del(got);
+}
+
+void test_linear_algebra_batch__cholesky_solve(void)
+{
+    const size_t n_rhs = 2;
+    m_batch_t *L = m_batch_new(N, N, COUNT), *B = m_batch_new(N, n_rhs, COUNT), *X = m_batch_new(N, n_rhs, COUNT);
+    m_t *a = m_new(N, N), *b_ref = m_new(N, n_rhs), *x = m_new(N, n_rhs), *ax = m_new(N, n_rhs);
+    cl_assert(L && B && X && a && b_ref && x && ax);
+
+    for (size_t b = 0; b < COUNT; b++) {
+        fill_spd(a, b);
+        fill_rhs(b_ref, b);
+        cl_assert_equal_i(m_batch_load(L, b, a), E_OK);
+        cl_assert_equal_i(m_batch_load(B, b, b_ref), E_OK);
+    }
+    cl_assert_equal_i(la_batch_cholesky(L, L), E_OK);
+
+    cl_assert_equal_i(la_batch_cholesky_solve(L, B, X), E_OK);
+    for (size_t b = 0; b < COUNT; b++) {
+        fill_spd(a, b);
+        fill_rhs(b_ref, b);
+        cl_assert_equal_i(m_batch_store(X, b, x), E_OK);
+        cl_assert_equal_i(m_mult(a, x, ax), E_OK);
+        cl_assert_(max_diff(ax, b_ref) < 1e-12, "A X should equal B in every lane.");
+    }
+
+    /* X == B solves in place to exactly the same answer. */
+    cl_assert_equal_i(la_batch_cholesky_solve(L, B, B), E_OK);
+    for (size_t b = 0; b < COUNT; b++) {
+        cl_assert_equal_i(m_batch_store(X, b, x), E_OK);
+        cl_assert_equal_i(m_batch_store(B, b, ax), E_OK);
+        cl_assert_(max_diff(ax, x) == 0.0, "In place solve should match out of place.");
+    }
+
+    m_batch_del(L); m_batch_del(B); m_batch_del(X);
+    m_del(a); m_del(b_ref); m_del(x); m_del(ax);
+}
+
+void test_linear_algebra_batch__bad_lane_is_isolated(void)
+{
+    m_batch_t *L = m_batch_new(N, N, COUNT), *B = m_batch_new(N, 1, COUNT);
+    m_t *a = m_new(N, N), *ref = m_new(N, N), *got = m_new(N, N), *rhs = m_new(N, 1), *x = m_new(N, 1);
+    cl_assert(L && B && a && ref && got && rhs && x);
+
+    for (size_t b = 0; b < COUNT; b++) {
+        fill_spd(a, b);
+        if (b == BAD_LANE) m_set(a, 2, 2, -50.0);
+        fill_rhs(rhs, b);
+        cl_assert_equal_i(m_batch_load(L, b, a), E_OK);
+        cl_assert_equal_i(m_batch_load(B, b, rhs), E_OK);
+    }
+
+    cl_assert_equal_i(la_batch_cholesky(L, L), E_OK);
+    cl_assert_equal_i(la_batch_cholesky_solve(L, B, B), E_OK);
+
+    for (size_t b = 0; b < COUNT; b++) {
+        cl_assert_equal_i(m_batch_store(L, b, got), E_OK);
+        cl_assert_equal_i(m_batch_store(B, b, x), E_OK);
+
+        if (b == BAD_LANE) {
+            cl_assert_(isnan(m_get(got, 2, 2)) && isnan(m_get(x, 0, 0)), "The indefinite lane should end up with NaNs.");
+            continue;
+        }
+
+        fill_spd(a, b);
+        cl_assert_equal_i(la_decompositions_cholesky(a, ref), E_OK);
+        cl_assert_(max_diff(got, ref) < 1e-13, "Good lanes shouldn't be affected by a bad one.");
+        for (size_t m = 0; m < N; m++)
+            cl_assert_(!isnan(m_get(x, m, 0)), "Good lanes should solve cleanly.");
+    }
+
+    m_batch_del(L); m_batch_del(B);
+    m_del(a); m_del(ref); m_del(got); m_del(rhs); m_del(x);
+}
@@ -0,0 +1,214 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/matrix.h"
+#include "data_structures/vector.h"
+#include "linear_algebra/decompositions.h"
+#include "parallel/thread_pool.h"
+
+void test_linear_algebra_decompositions__initialize(void) {
+    global_test_counter++;
+}
+
+void test_linear_algebra_decompositions__cleanup(void)
+{
+    parallel_set_threads(0);
+}
+
+/* A dense symmetric matrix with well separated, known-free eigenvalues. */
+static void fill_symmetric(m_t *A)
+{
+    for (size_t m = 0; m < A->rows; m++)
+        for (size_t n = 0; n <= m; n++) {
+            m_data_t a = sin(1.0 + m*A->cols + n) + (m == n ? (m_data_t)m : 0.0);
+            m_set(A, m, n, a);
+            m_set(A, n, m, a);
+        }
+}
+
+/* Largest |A v - w v| over all the eigenpairs in V. */
+static m_data_t eigen_residual(m_t *A, v_t *w, m_t *V)
+{
+    m_data_t worst = 0.0;
+    for (size_t k = 0; k < V->cols; k++)
+        for (size_t m = 0; m < A->rows; m++) {
+            m_data_t r = -w->data[k]*m_get(V, m, k);
+            for (size_t n = 0; n < A->cols; n++)
+                r += m_get(A, m, n)*m_get(V, n, k);
+            worst = fabs(r) > worst ? fabs(r) : worst;
+        }
+    return worst;
+}
+
+void test_linear_algebra_decompositions__symmetric_eigen_known(void)
+{
+    /* Eigenvalues 1, 3 and 4 - tridiagonal already, with a zero coupling. */
+    m_data_t a[] = {2, 1, 0,
+                    1, 2, 0,
+                    0, 0, 4};
+    m_t A;
+    v_t *w = v_new(3);
+    m_t *V = m_new(3, 3);
+    cl_assert(w && V);
+    cl_assert_equal_i(m_init_view(&A, 3, 3, M_ROW_MAJOR, a), E_OK);
+
+    cl_assert_equal_i(la_decompositions_symmetric_eigen(&A, w, V), E_OK);
+    cl_assert_(fabs(w->data[0] - 1) < 1e-14 && fabs(w->data[1] - 3) < 1e-14 && fabs(w->data[2] - 4) < 1e-14,
+               "Eigenvalues should be 1, 3, 4.");
+    cl_assert_(eigen_residual(&A, w, V) < 1e-14, "A v should equal w v.");
+
+    a[1] = 0.5;
+    cl_assert_equal_i_(la_decompositions_symmetric_eigen(&A, w, V), E_VAL, "A must be symmetric.");
+
+    v_del(w);
+    m_del(V);
+}
+
+void test_linear_algebra_decompositions__symmetric_eigen_dense(void)
+{
+    const size_t n = 20;
+    m_t *A = m_new(n, n);
+    m_t *V = m_new_ordered(n, n, M_COL_MAJOR);
+    v_t *w = v_new(n);
+    v_t *w_only = v_new(n);
+    cl_assert(A && V && w && w_only);
+
+    fill_symmetric(A);
+    cl_assert_equal_i(la_decompositions_symmetric_eigen(A, w, V), E_OK);
+    cl_assert_(eigen_residual(A, w, V) < 1e-12, "A v should equal w v.");
+
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            m_data_t dot;
+            cl_assert_equal_i(m_column_dot_product(V, i, V, j, &dot), E_OK);
+            cl_assert_(fabs(dot - (i == j)) < 1e-12, "Eigenvectors should be orthonormal.");
+        }
+
+    cl_assert_equal_i(la_decompositions_symmetric_eigen(A, w_only, NULL), E_OK);
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0) cl_assert_(w->data[i-1] <= w->data[i], "Eigenvalues should be ascending.");
+        cl_assert_(fabs(w->data[i] - w_only->data[i]) < 1e-12, "Eigenvalue-only path should agree.");
+    }
+
+    m_del(A);
+    m_del(V);
+    v_del(w);
+    v_del(w_only);
+}
+
+void test_linear_algebra_decompositions__symmetric_eigen_extreme(void)
+{
+    const size_t n = 30, k = 3;
+    m_t *A = m_new(n, n);
+    m_t *V = m_new(n, k);
+    v_t *all = v_new(n);
+    v_t *w = v_new(k);
+    cl_assert(A && V && all && w);
+
+    fill_symmetric(A);
+    cl_assert_equal_i(la_decompositions_symmetric_eigen(A, all, NULL), E_OK);
+
+    cl_assert_equal_i(la_decompositions_symmetric_eigen_extreme(A, k, false, w, V), E_OK);
+    for (size_t i = 0; i < k; i++)
+        cl_assert_(fabs(w->data[i] - all->data[i]) < 1e-12, "Wrong smallest eigenvalues.");
+    cl_assert_(eigen_residual(A, w, V) < 1e-10, "Smallest eigenpairs don't satisfy A v = w v.");
+
+    cl_assert_equal_i(la_decompositions_symmetric_eigen_extreme(A, k, true, w, V), E_OK);
+    for (size_t i = 0; i < k; i++)
+        cl_assert_(fabs(w->data[i] - all->data[n-1-i]) < 1e-12, "Wrong largest eigenvalues.");
+    cl_assert_(eigen_residual(A, w, V) < 1e-10, "Largest eigenpairs don't satisfy A v = w v.");
+
+    cl_assert_equal_i_(la_decompositions_symmetric_eigen_extreme(A, n+1, true, w, NULL), E_VAL, "k can't exceed n.");
+
+    m_del(A);
+    m_del(V);
+    v_del(all);
+    v_del(w);
+}
+
+/* Big enough to take the blocked, parallel paths. */
+#define BIG_N 150
+
+static int m_bits_equal(m_t *a, m_t *b)
+{
+    for (size_t m = 0; m < a->rows; m++)
+        for (size_t n = 0; n < a->cols; n++) {
+            m_data_t x = m_get(a, m, n), y = m_get(b, m, n);
+            if (memcmp(&x, &y, sizeof(x))) return 0;
+        }
+    return 1;
+}
+
+void test_linear_algebra_decompositions__cholesky_blocked(void)
+{
+    m_t *A = m_new(BIG_N, BIG_N);
+    m_t *L1 = m_new(BIG_N, BIG_N);
+    m_t *L4 = m_new(BIG_N, BIG_N);
+    cl_assert(A && L1 && L4);
+
+    /* Symmetric and diagonally dominant, so positive definite. */
+    for (size_t m = 0; m < BIG_N; m++)
+        for (size_t n = 0; n < BIG_N; n++)
+            m_set(A, m, n, 0.5*sin(1.0 + m*n) + (m == n ? (m_data_t)BIG_N : 0.0));
+
+    cl_assert_equal_i(parallel_set_threads(1), E_OK);
+    cl_assert_equal_i(la_decompositions_cholesky(A, L1), E_OK);
+    cl_assert_equal_i(parallel_set_threads(4), E_OK);
+    cl_assert_equal_i(la_decompositions_cholesky(A, L4), E_OK);
+    cl_assert_(m_bits_equal(L1, L4), "Cholesky should not depend on the thread count.");
+
+    m_data_t err = 0;
+    for (size_t m = 0; m < BIG_N; m++)
+        for (size_t n = 0; n < BIG_N; n++) {
+            m_data_t s = 0;
+            if (n > m) cl_assert_(m_get(L4, m, n) == 0, "L should be lower triangular.");
+            for (size_t k = 0; k < BIG_N; k++)
+                s += m_get(L4, m, k)*m_get(L4, n, k);
+            err = fmax(err, fabs(s - m_get(A, m, n)));
+        }
+    cl_assert_(err < 1e-11, "L*L^T should reconstruct A.");
+
+    m_del(A); m_del(L1); m_del(L4);
+}
+
+void test_linear_algebra_decompositions__qr_blocked(void)
+{
+    m_t *A = m_new(BIG_N, BIG_N);
+    m_t *Q1 = m_new(BIG_N, BIG_N), *R1 = m_new(BIG_N, BIG_N);
+    m_t *Q4 = m_new(BIG_N, BIG_N), *R4 = m_new(BIG_N, BIG_N);
+    cl_assert(A && Q1 && R1 && Q4 && R4);
+
+    for (size_t m = 0; m < BIG_N; m++)
+        for (size_t n = 0; n < BIG_N; n++)
+            m_set(A, m, n, sin(1.0 + m*BIG_N + n) + (m == n ? 2.0 : 0.0));
+
+    cl_assert_equal_i(parallel_set_threads(1), E_OK);
+    cl_assert_equal_i(la_decompositions_qr(A, Q1, R1), E_OK);
+    cl_assert_equal_i(parallel_set_threads(4), E_OK);
+    cl_assert_equal_i(la_decompositions_qr(A, Q4, R4), E_OK);
+    cl_assert_(m_bits_equal(Q1, Q4) && m_bits_equal(R1, R4), "QR should not depend on the thread count.");
+
+    m_data_t rec = 0, orth = 0;
+    for (size_t m = 0; m < BIG_N; m++)
+        for (size_t n = 0; n < BIG_N; n++) {
+            m_data_t qr = 0, qtq = 0;
+            if (m > n) cl_assert_(m_get(R4, m, n) == 0, "R should be upper triangular.");
+            for (size_t k = 0; k < BIG_N; k++) {
+                qr += m_get(Q4, m, k)*m_get(R4, k, n);
+                qtq += m_get(Q4, k, m)*m_get(Q4, k, n);
+            }
+            rec = fmax(rec, fabs(qr - m_get(A, m, n)));
+            orth = fmax(orth, fabs(qtq - (m == n ? 1.0 : 0.0)));
+        }
+    cl_assert_(rec < 1e-11, "Q*R should reconstruct A.");
+    cl_assert_(orth < 1e-11, "Q should be orthogonal.");
+
+    m_del(A); m_del(Q1); m_del(R1); m_del(Q4); m_del(R4);
+}
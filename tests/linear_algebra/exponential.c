@@ -0,0 +1,63 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/matrix.h"
+#include "linear_algebra/exponential.h"
+
+void test_linear_algebra_exponential__initialize(void) {
+    global_test_counter++;
+}
+
+void test_linear_algebra_exponential__cleanup(void)
+{
+}
+
+void test_linear_algebra_exponential__rotation(void)
+{
+    /* e^([0 -w; w 0]) is a rotation by w.  The angles hit every Pade degree
+       and, for the big one, scaling and squaring too.
+    */
+    const double angles[] = {1e-3, 0.1, 0.5, 1.5, 4.0, 50.0};
+    m_t *A = m_new(2, 2), *E = m_new_ordered(2, 2, M_COL_MAJOR);
+    cl_assert(A && E);
+
+    for (size_t i = 0; i < array_length(angles); i++) {
+        const double w = angles[i];
+        m_set(A, 0, 0, 0); m_set(A, 0, 1, -w);
+        m_set(A, 1, 0, w); m_set(A, 1, 1, 0);
+
+        cl_assert_equal_i(la_expm(A, E), E_OK);
+        cl_assert_(fabs(m_get(E, 0, 0) - cos(w)) < 1e-13*(1 + w) && fabs(m_get(E, 1, 1) - cos(w)) < 1e-13*(1 + w),
+                   "Diagonal of a rotation should be cos(w).");
+        cl_assert_(fabs(m_get(E, 1, 0) - sin(w)) < 1e-13*(1 + w) && fabs(m_get(E, 0, 1) + sin(w)) < 1e-13*(1 + w),
+                   "Off diagonal of a rotation should be +-sin(w).");
+    }
+
+    m_del(A);
+    m_del(E);
+}
+
+void test_linear_algebra_exponential__in_place(void)
+{
+    /* Nilpotent: e^N = I + N + N^2/2 exactly. */
+    m_data_t n[] = {0, 2, 3,
+                    0, 0, 4,
+                    0, 0, 0};
+    m_t N;
+    cl_assert_equal_i(m_init_view(&N, 3, 3, M_ROW_MAJOR, n), E_OK);
+
+    cl_assert_equal_i(la_expm(&N, &N), E_OK);
+    cl_assert_(fabs(n[0] - 1) < 1e-14 && fabs(n[1] - 2) < 1e-14 && fabs(n[2] - 7) < 1e-14, "First row is wrong.");
+    cl_assert_(fabs(n[4] - 1) < 1e-14 && fabs(n[5] - 4) < 1e-14 && fabs(n[8] - 1) < 1e-14, "Diagonal or second row is wrong.");
+    cl_assert_(n[3] == 0 && n[6] == 0 && n[7] == 0, "Should stay upper triangular.");
+
+    m_t *R = m_new(3, 2);
+    cl_assert_equal_i_(la_expm(R, R), E_VAL, "A must be square.");
+    m_del(R);
+}
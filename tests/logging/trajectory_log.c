@@ -0,0 +1,223 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "logging/trajectory_log.h"
+
+static char path[64];
+
+void test_logging_trajectory_log__initialize(void) {
+    global_test_counter++;
+
+    snprintf(path, sizeof path, "/tmp/traj_log_XXXXXX");
+    int fd = mkstemp(path);
+    cl_assert(fd >= 0);
+    close(fd);
+}
+
+void test_logging_trajectory_log__cleanup(void)
+{
+    unlink(path);
+}
+
+void test_logging_trajectory_log__round_trip(void)
+{
+    v_data_t st_data[3];
+    v_t st = { .len = 3, .data = st_data };
+    m_t *cov = m_new_ordered(2, 2, M_COL_MAJOR);
+    traj_log_record_t rec;
+    cl_assert(cov);
+
+    /* Every third of ten snapshots is kept: 0, 3, 6 and 9. */
+    traj_log_writer_t *w = traj_log_writer_new(path, 3, 2, 2, 16, 3);
+    cl_assert(w);
+    for (size_t i = 0; i < 10; i++) {
+        st_data[0] = i;
+        st_data[1] = i + 0.5;
+        st_data[2] = -(v_data_t)i;
+        for (size_t m = 0; m < 2; m++)
+            for (size_t n = 0; n < 2; n++)
+                m_set(cov, m, n, 10.0*i + 2*m + n);
+        cl_assert_equal_i(traj_log_writer_push(w, 0.25*i, &st, cov), E_OK);
+    }
+    cl_assert_equal_i(traj_log_writer_dropped(w), 0);
+    cl_assert_equal_i(traj_log_writer_close(w), E_OK);
+
+    traj_log_reader_t *r = traj_log_reader_open(path);
+    cl_assert(r);
+    const traj_log_header_t *h = traj_log_reader_header(r);
+    cl_assert(h->state_len == 3 && h->cov_rows == 2 && h->cov_cols == 2);
+    cl_assert_equal_i(h->decimation, 3);
+    cl_assert_equal_i(traj_log_reader_len(r), 4);
+
+    for (size_t k = 0; k < 4; k++) {
+        const size_t i = 3*k;
+        cl_assert_equal_i(traj_log_reader_record(r, k, &rec), E_OK);
+        cl_assert(rec.t == 0.25*i);
+        cl_assert(rec.state.len == 3);
+        cl_assert(rec.state.data[0] == i && rec.state.data[1] == i + 0.5 && rec.state.data[2] == -(v_data_t)i);
+
+        /* Pushed col-major, read back row-major. */
+        cl_assert(rec.cov.order == M_ROW_MAJOR && rec.cov.rows == 2 && rec.cov.cols == 2);
+        for (size_t m = 0; m < 2; m++)
+            for (size_t n = 0; n < 2; n++)
+                cl_assert_(rec.cov.data[m*2 + n] == 10.0*i + 2*m + n, "Covariance came back wrong.");
+    }
+    cl_assert_equal_i_(traj_log_reader_record(r, 4, &rec), E_VAL, "Reading past the end should fail.");
+
+    cl_assert_equal_i(traj_log_reader_close(r), E_OK);
+    m_del(cov);
+}
+
+void test_logging_trajectory_log__dropped(void)
+{
+    v_data_t x = 0;
+    v_t st = { .len = 1, .data = &x };
+    size_t pushed = 0;
+    traj_log_record_t rec;
+
+    /* A two slot ring can't keep up with a tight loop for long. */
+    traj_log_writer_t *w = traj_log_writer_new(path, 1, 0, 0, 2, 1);
+    cl_assert(w);
+    while (traj_log_writer_dropped(w) < 100 && pushed < 100000000) {
+        x = pushed;
+        cl_assert_equal_i(traj_log_writer_push(w, (double)pushed, &st, NULL), E_OK);
+        pushed++;
+    }
+    const size_t dropped = traj_log_writer_dropped(w);
+    cl_assert_(dropped >= 100, "A full ring should drop snapshots.");
+    cl_assert_equal_i(traj_log_writer_close(w), E_OK);
+
+    /* Whatever wasn't dropped made it to disk, in order and intact. */
+    traj_log_reader_t *r = traj_log_reader_open(path);
+    cl_assert(r);
+    cl_assert_equal_i(traj_log_reader_len(r) + dropped, pushed);
+
+    double last = -1;
+    for (size_t k = 0; k < traj_log_reader_len(r); k++) {
+        cl_assert_equal_i(traj_log_reader_record(r, k, &rec), E_OK);
+        cl_assert(rec.t > last && rec.state.data[0] == rec.t);
+        last = rec.t;
+    }
+
+    traj_log_reader_close(r);
+}
+
+static void read_header(traj_log_header_t *h)
+{
+    FILE *f = fopen(path, "rb");
+    cl_assert(f);
+    cl_assert(fread(h, sizeof *h, 1, f) == 1);
+    cl_assert(fclose(f) == 0);
+}
+
+static void write_header(const traj_log_header_t *h)
+{
+    FILE *f = fopen(path, "r+b");
+    cl_assert(f);
+    cl_assert(fwrite(h, sizeof *h, 1, f) == 1);
+    cl_assert(fclose(f) == 0);
+}
+
+/* Writes bad over the log's header and checks the reader rejects it, then
+   puts the original header back.
+*/
+static void assert_rejected(const traj_log_header_t *bad, const char *msg)
+{
+    traj_log_header_t orig;
+
+    read_header(&orig);
+    write_header(bad);
+    cl_assert_(traj_log_reader_open(path) == NULL, msg);
+    write_header(&orig);
+}
+
+/* A good log of one record with a state of 2 and no covariance. */
+static void write_small_log(traj_log_header_t *h)
+{
+    v_data_t st_data[2] = { 1, 2 };
+    v_t st = { .len = 2, .data = st_data };
+
+    traj_log_writer_t *w = traj_log_writer_new(path, 2, 0, 0, 4, 1);
+    cl_assert(w);
+    cl_assert_equal_i(traj_log_writer_push(w, 0.0, &st, NULL), E_OK);
+    cl_assert_equal_i(traj_log_writer_close(w), E_OK);
+
+    read_header(h);
+}
+
+void test_logging_trajectory_log__bad_header(void)
+{
+    traj_log_header_t good, h;
+    traj_log_reader_t *r;
+
+    write_small_log(&good);
+
+    h = good;
+    memcpy(h.magic, "DYNTRAX", 8);
+    assert_rejected(&h, "Bad magic should be rejected.");
+
+    h = good;
+    h.version = TRAJ_LOG_VERSION + 1;
+    assert_rejected(&h, "Bad version should be rejected.");
+
+    h = good;
+    h.dtype = 7;
+    assert_rejected(&h, "Bad dtype should be rejected.");
+
+    h = good;
+    h.record_size = 2*sizeof(m_data_t);
+    assert_rejected(&h, "A record size that doesn't match the shape should be rejected.");
+
+    /* Everything was put back, so the log opens again. */
+    r = traj_log_reader_open(path);
+    cl_assert(r);
+    cl_assert_equal_i(traj_log_reader_len(r), 1);
+    traj_log_reader_close(r);
+
+    cl_assert_(truncate(path, TRAJ_LOG_HEADER_SIZE - 1) == 0 && traj_log_reader_open(path) == NULL,
+               "A truncated header should be rejected.");
+    cl_assert_(traj_log_reader_open(NULL) == NULL, "NULL path should fail.");
+}
+
+void test_logging_trajectory_log__bad_shape(void)
+{
+    traj_log_header_t good, h;
+
+    write_small_log(&good);
+
+    h = good;
+    h.record_size = 0;
+    assert_rejected(&h, "A zero record size should be rejected.");
+
+    h = good;
+    h.state_len = 0;
+    h.record_size = sizeof(m_data_t);
+    assert_rejected(&h, "An empty state should be rejected.");
+
+    /* One zero covariance dimension leaves record_size unchanged. */
+    h = good;
+    h.cov_rows = 1;
+    assert_rejected(&h, "A covariance with only one zero dimension should be rejected.");
+
+    /* Each of these wraps to the record size it is paired with. */
+    h = good;
+    h.cov_rows = h.cov_cols = (uint64_t)1 << 32;
+    assert_rejected(&h, "An overflowing covariance size should be rejected.");
+
+    h = good;
+    h.state_len = UINT64_MAX;
+    h.record_size = 0;
+    assert_rejected(&h, "An overflowing record length should be rejected.");
+
+    h = good;
+    h.state_len = ((uint64_t)1 << 61) - 1;
+    h.record_size = 0;
+    assert_rejected(&h, "An overflowing record size should be rejected.");
+}
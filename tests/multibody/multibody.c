@@ -0,0 +1,122 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "data_structures/vector.h"
+#include "multibody/multibody.h"
+
+static const v_data_t gravity[3] = {0, -9.81, 0};
+
+void test_multibody_multibody__initialize(void) {
+    global_test_counter++;
+}
+
+void test_multibody_multibody__cleanup(void)
+{
+}
+
+/* A point mass m on a massless link of length l, hinged about z at pos in
+   its parent's frame and lying along x when q = 0.
+*/
+static multibody_body_t link(size_t parent, v_data_t pos_x, v_data_t m, v_data_t l)
+{
+    return (multibody_body_t){
+        .parent = parent,
+        .joint = MULTIBODY_REVOLUTE,
+        .axis = {0, 0, 1},
+        .rot = {1, 0, 0, 0, 1, 0, 0, 0, 1},
+        .pos = {pos_x, 0, 0},
+        .mass = m,
+        .com = {l, 0, 0},
+    };
+}
+
+void test_multibody_multibody__pendulum(void)
+{
+    const v_data_t l = 0.7;
+    multibody_body_t body = link(MULTIBODY_BASE, 0, 2.0, l);
+    multibody_t *model = multibody_new(&body, 1, gravity);
+    v_t *st = v_new(2), *rate = v_new(2), *tau = v_new_zeros(1);
+    cl_assert(model && st && rate && tau);
+
+    cl_assert_equal_i(multibody_dof(model), 1);
+    cl_assert_equal_i(multibody_bind(model), E_OK);
+
+    for (v_data_t q = -3; q < 3; q += 0.5) {
+        st->data[0] = q;
+        st->data[1] = 1.5;
+        cl_assert_equal_i(multibody_state_fn(st, tau, rate), E_OK);
+        cl_assert_(rate->data[0] == 1.5, "The first half of the rate should be qd.");
+        cl_assert_(fabs(rate->data[1] + 9.81*cos(q)/l) < 1e-12, "Pendulum should have qdd = -g cos(q)/l.");
+    }
+
+    /* Torque balancing gravity holds it still. */
+    st->data[0] = 0.3;
+    st->data[1] = 0;
+    tau->data[0] = 2.0*9.81*l*cos(0.3);
+    cl_assert_equal_i(multibody_state_fn(st, tau, rate), E_OK);
+    cl_assert_(fabs(rate->data[1]) < 1e-12, "Balanced pendulum shouldn't accelerate.");
+
+    multibody_del(model);
+    v_del(st); v_del(rate); v_del(tau);
+}
+
+void test_multibody_multibody__prismatic(void)
+{
+    multibody_body_t body = {
+        .parent = MULTIBODY_BASE,
+        .joint = MULTIBODY_PRISMATIC,
+        .axis = {0, 1, 0},
+        .rot = {1, 0, 0, 0, 1, 0, 0, 0, 1},
+        .mass = 4.0,
+        .inertia = {1, 0, 0, 0, 1, 0, 0, 0, 1},
+    };
+    multibody_t *model = multibody_new(&body, 1, gravity);
+    v_t *q = v_new_zeros(1), *qd = v_new_ones(1), *tau = v_new_from_value(2.0, 1), *qdd = v_new(1);
+    cl_assert(model && q && qd && tau && qdd);
+
+    cl_assert_equal_i(multibody_forward_dynamics(model, q, qd, tau, qdd), E_OK);
+    cl_assert_(fabs(qdd->data[0] - (-9.81 + 2.0/4.0)) < 1e-12, "Slider should fall at g less tau/m.");
+
+    multibody_del(model);
+    v_del(q); v_del(qd); v_del(tau); v_del(qdd);
+}
+
+void test_multibody_multibody__double_pendulum(void)
+{
+    const v_data_t m1 = 1.3, m2 = 0.8, l1 = 1.1, l2 = 0.6, g = 9.81;
+    multibody_body_t bodies[2] = { link(MULTIBODY_BASE, 0, m1, l1), link(0, l1, m2, l2) };
+    multibody_t *model = multibody_new(bodies, 2, gravity);
+    v_t *q = v_new(2), *qd = v_new(2), *tau = v_new(2), *qdd = v_new(2);
+    cl_assert(model && q && qd && tau && qdd);
+
+    q->data[0] = 0.4;  q->data[1] = -1.2;
+    qd->data[0] = 0.9; qd->data[1] = -2.1;
+    tau->data[0] = 0.5; tau->data[1] = -0.25;
+    cl_assert_equal_i(multibody_forward_dynamics(model, q, qd, tau, qdd), E_OK);
+
+    /* The closed form M(q) qdd = tau - C(q, qd) - G(q). */
+    const v_data_t c2 = cos(q->data[1]), s2 = sin(q->data[1]);
+    const v_data_t c1 = cos(q->data[0]), c12 = cos(q->data[0] + q->data[1]);
+    const v_data_t M11 = m1*l1*l1 + m2*(l1*l1 + l2*l2 + 2*l1*l2*c2);
+    const v_data_t M12 = m2*(l2*l2 + l1*l2*c2);
+    const v_data_t M22 = m2*l2*l2;
+    const v_data_t C1 = -m2*l1*l2*s2*(2*qd->data[0]*qd->data[1] + qd->data[1]*qd->data[1]);
+    const v_data_t C2 = m2*l1*l2*s2*qd->data[0]*qd->data[0];
+    const v_data_t G1 = g*((m1 + m2)*l1*c1 + m2*l2*c12);
+    const v_data_t G2 = g*m2*l2*c12;
+
+    cl_assert_(fabs(M11*qdd->data[0] + M12*qdd->data[1] - (tau->data[0] - C1 - G1)) < 1e-10, "Joint 1 equation doesn't hold.");
+    cl_assert_(fabs(M12*qdd->data[0] + M22*qdd->data[1] - (tau->data[1] - C2 - G2)) < 1e-10, "Joint 2 equation doesn't hold.");
+
+    bodies[0].parent = 1;
+    cl_assert_(multibody_new(bodies, 2, gravity) == NULL, "Parents must come before their children.");
+
+    multibody_del(model);
+    v_del(q); v_del(qd); v_del(tau); v_del(qdd);
+}
@@ -0,0 +1,195 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/* Includes from the testing source tree */
+#include "clar.h"
+#include "test.h"
+
+/* Includes from the project source tree */
+#include "parallel/thread_pool.h"
+
+void test_parallel_thread_pool__initialize(void) {
+    global_test_counter++;
+}
+
+void test_parallel_thread_pool__cleanup(void)
+{
+    parallel_set_threads(0);
+}
+
+#define N_TASKS 300
+
+/* Each task takes a ticket when it runs, so finish order can be checked. */
+typedef struct order_ctx {
+    size_t ticket;
+    size_t order[N_TASKS];
+    pthread_t thread[N_TASKS];
+} order_ctx_t;
+
+static void order_task(void *ctx, size_t id, size_t unused)
+{
+    order_ctx_t *c = ctx;
+    (void)unused;
+
+    /* Give other workers a chance to run things out of order. */
+    if (id % 7 == 0) usleep(50);
+    c->thread[id] = pthread_self();
+    c->order[id] = __sync_fetch_and_add(&c->ticket, 1);
+}
+
+/* Task t depends on up to three earlier tasks picked by a fixed LCG. */
+static size_t deps_of(size_t t, size_t deps[3])
+{
+    size_t n = 0, x = t*2654435761u;
+    for (size_t k = 0; k < 3 && t > 0; k++) {
+        x = x*1103515245u + 12345u;
+        deps[n++] = (x >> 8) % t;
+    }
+    return n;
+}
+
+static void run_ordered(size_t n_threads, order_ctx_t *c)
+{
+    cl_assert_equal_i(parallel_set_threads(n_threads), E_OK);
+    cl_assert_equal_i(parallel_get_threads(), n_threads);
+
+    parallel_graph_t *g = parallel_graph_new(c);
+    cl_assert(g);
+    for (size_t t = 0; t < N_TASKS; t++) {
+        size_t id, deps[3];
+        cl_assert_equal_i(parallel_graph_add(g, order_task, t, 0, &id), E_OK);
+        cl_assert_equal_i(id, t);
+        for (size_t d = 0; d < deps_of(t, deps); d++)
+            cl_assert_equal_i(parallel_graph_depend(g, t, deps[d]), E_OK);
+    }
+
+    /* Twice, since a graph must be rerunnable. */
+    for (size_t run = 0; run < 2; run++) {
+        c->ticket = 0;
+        cl_assert_equal_i(parallel_graph_run(g), E_OK);
+        cl_assert_equal_i(c->ticket, N_TASKS);
+
+        for (size_t t = 0; t < N_TASKS; t++) {
+            size_t deps[3];
+            for (size_t d = 0; d < deps_of(t, deps); d++)
+                cl_assert_(c->order[deps[d]] < c->order[t], "A task ran before something it depends on.");
+        }
+    }
+
+    parallel_graph_del(g);
+}
+
+void test_parallel_thread_pool__dependency_order(void)
+{
+    static order_ctx_t c;
+    run_ordered(4, &c);
+}
+
+void test_parallel_thread_pool__set_threads(void)
+{
+    static order_ctx_t c;
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    cl_assert_equal_i(parallel_set_threads(0), E_OK);
+    cl_assert_equal_i(parallel_get_threads(), cpus > 0 ? (size_t)cpus : 1);
+
+    /* One thread runs everything on the caller. */
+    run_ordered(1, &c);
+    for (size_t t = 0; t < N_TASKS; t++)
+        cl_assert_(pthread_equal(c.thread[t], pthread_self()), "With one thread everything should run on the caller.");
+
+    /* Changing the count restarts the pool, which must still work. */
+    run_ordered(3, &c);
+    run_ordered(4, &c);
+}
+
+/* An outer task that runs a whole graph of its own. */
+typedef struct nested_ctx {
+    size_t inner_done[8];
+    int inner_on_outer_thread[8];
+} nested_ctx_t;
+
+typedef struct inner_ctx {
+    nested_ctx_t *outer;
+    size_t idx;
+    pthread_t thread;
+} inner_ctx_t;
+
+static void inner_task(void *ctx, size_t i, size_t unused)
+{
+    inner_ctx_t *c = ctx;
+    (void)i; (void)unused;
+
+    __sync_fetch_and_add(&c->outer->inner_done[c->idx], 1);
+    if (!pthread_equal(c->thread, pthread_self()))
+        c->outer->inner_on_outer_thread[c->idx] = 0;
+}
+
+static void outer_task(void *ctx, size_t idx, size_t unused)
+{
+    nested_ctx_t *c = ctx;
+    inner_ctx_t inner = { .outer = c, .idx = idx, .thread = pthread_self() };
+    (void)unused;
+
+    c->inner_on_outer_thread[idx] = 1;
+    parallel_graph_t *g = parallel_graph_new(&inner);
+    if (!g) return;
+    for (size_t t = 0; t < 16; t++)
+        parallel_graph_add(g, inner_task, t, 0, NULL);
+    parallel_graph_run(g);
+    parallel_graph_del(g);
+}
+
+void test_parallel_thread_pool__nested_runs_serial(void)
+{
+    nested_ctx_t c = {{0}, {0}};
+
+    cl_assert_equal_i(parallel_set_threads(4), E_OK);
+    parallel_graph_t *g = parallel_graph_new(&c);
+    cl_assert(g);
+    for (size_t t = 0; t < 8; t++)
+        cl_assert_equal_i(parallel_graph_add(g, outer_task, t, 0, NULL), E_OK);
+
+    cl_assert_equal_i(parallel_graph_run(g), E_OK);
+    for (size_t t = 0; t < 8; t++) {
+        cl_assert_equal_i(c.inner_done[t], 16);
+        cl_assert_(c.inner_on_outer_thread[t], "A nested graph should run serially on the task's own thread.");
+    }
+
+    parallel_graph_del(g);
+}
+
+static void nop_task(void *ctx, size_t i, size_t j)
+{
+    (void)ctx; (void)i; (void)j;
+}
+
+void test_parallel_thread_pool__errors(void)
+{
+    size_t id;
+    parallel_graph_t *g = parallel_graph_new(NULL);
+    cl_assert(g);
+
+    cl_assert_equal_i(parallel_graph_run(g), E_OK);
+
+    cl_assert_equal_i_(parallel_graph_add(NULL, nop_task, 0, 0, &id), E_NULLP, "NULL graph should fail.");
+    cl_assert_equal_i_(parallel_graph_add(g, NULL, 0, 0, &id), E_NULLP, "NULL task function should fail.");
+    cl_assert_equal_i_(parallel_graph_depend(NULL, 1, 0), E_NULLP, "NULL graph should fail.");
+    cl_assert_equal_i_(parallel_graph_run(NULL), E_NULLP, "NULL graph should fail.");
+
+    cl_assert_equal_i(parallel_graph_add(g, nop_task, 0, 0, NULL), E_OK);
+    cl_assert_equal_i(parallel_graph_add(g, nop_task, 1, 0, NULL), E_OK);
+    cl_assert_equal_i_(parallel_graph_depend(g, 0, 1), E_VAL, "Depending on a later task would allow cycles.");
+    cl_assert_equal_i_(parallel_graph_depend(g, 1, 1), E_VAL, "A task can't depend on itself.");
+    cl_assert_equal_i_(parallel_graph_depend(g, 2, 0), E_VAL, "Unknown task should fail.");
+
+    /* A rejected dependency leaves the graph usable. */
+    cl_assert_equal_i(parallel_graph_depend(g, 1, 0), E_OK);
+    cl_assert_equal_i(parallel_set_threads(4), E_OK);
+    cl_assert_equal_i(parallel_graph_run(g), E_OK);
+
+    cl_assert_equal_i(parallel_graph_del(g), E_OK);
+    cl_assert_equal_i(parallel_graph_del(NULL), E_OK);
+}